@@ -0,0 +1,19 @@
+#include <cstdio>
+#include <stdexcept>
+#include "arrival.h"
+
+const char *arrival_distribution_name[] = {
+	"deterministic", "exponential", "uniform"
+};
+
+ArrivalProcess::ArrivalProcess(ArrivalDistribution distribution, double mean_gap_ns, uint64_t seed)
+	: distribution(distribution), mean_gap_ns(mean_gap_ns), rng(seed), exponential(1.0), uniform(0.0, 1.0), carry_ns(0) {}
+
+ArrivalDistribution ArrivalProcess::parse_distribution(const std::string &name) {
+	for (int i = 0; i < NR_ARRIVAL_DISTRIBUTION; ++i) {
+		if (name == arrival_distribution_name[i])
+			return (ArrivalDistribution) i;
+	}
+	fprintf(stderr, "ArrivalProcess: unknown arrival distribution %s\n", name.c_str());
+	throw std::invalid_argument("unknown arrival distribution");
+}
@@ -0,0 +1,109 @@
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+#include "histogram.h"
+
+LatencyHistogram::LatencyHistogram(int precision_bits)
+: precision_bits(precision_bits) {
+	if (precision_bits < min_precision_bits || precision_bits > max_precision_bits)
+		throw std::invalid_argument("histogram precision_bits out of range");
+	this->sub_bucket_count = 1L << precision_bits;
+	/* one linear range below 2^precision_bits, then one range per remaining power of two */
+	this->counts.resize((unsigned long) ((64 - precision_bits) * this->sub_bucket_count), 0);
+	this->reset();
+}
+
+long LatencyHistogram::bucket_index(long value) const {
+	if (value < this->sub_bucket_count)
+		return value < 0 ? 0 : value;
+	int msb = 63 - __builtin_clzl((unsigned long) value);
+	int shift = msb - this->precision_bits;
+	return ((long) shift) * this->sub_bucket_count + (value >> shift);
+}
+
+long LatencyHistogram::bucket_lower_bound(long index) const {
+	if (index < 2 * this->sub_bucket_count)
+		return index;
+	long shift = index / this->sub_bucket_count - 1;
+	return (index - shift * this->sub_bucket_count) << shift;
+}
+
+long LatencyHistogram::bucket_upper_bound(long index) const {
+	if (index < 2 * this->sub_bucket_count)
+		return index;
+	long shift = index / this->sub_bucket_count - 1;
+	return this->bucket_lower_bound(index) + (1L << shift) - 1;
+}
+
+void LatencyHistogram::record(long value) {
+	++this->counts[(unsigned long) this->bucket_index(value)];
+	++this->total_count;
+	this->total_sum += (double) value;
+	if (value < this->min_value)
+		this->min_value = value;
+	if (value > this->max_value)
+		this->max_value = value;
+}
+
+void LatencyHistogram::merge(const LatencyHistogram &other) {
+	if (other.precision_bits != this->precision_bits)
+		throw std::invalid_argument("cannot merge histograms with different precision");
+	if (other.total_count == 0)
+		return;
+	for (size_t i = 0; i < this->counts.size(); ++i) {
+		this->counts[i] += other.counts[i];
+	}
+	this->total_count += other.total_count;
+	this->total_sum += other.total_sum;
+	this->min_value = std::min(this->min_value, other.min_value);
+	this->max_value = std::max(this->max_value, other.max_value);
+}
+
+void LatencyHistogram::reset() {
+	std::fill(this->counts.begin(), this->counts.end(), 0);
+	this->total_count = 0;
+	this->total_sum = 0;
+	this->min_value = std::numeric_limits<long>::max();
+	this->max_value = 0;
+}
+
+long LatencyHistogram::get_count() const {
+	return this->total_count;
+}
+
+long LatencyHistogram::get_min() const {
+	return this->total_count == 0 ? 0 : this->min_value;
+}
+
+long LatencyHistogram::get_max() const {
+	return this->max_value;
+}
+
+double LatencyHistogram::get_average() const {
+	if (this->total_count == 0)
+		return 0;
+	return this->total_sum / (double) this->total_count;
+}
+
+double LatencyHistogram::get_percentile(double percentile) const {
+	if (this->total_count == 0)
+		return 0;
+	if (percentile < 0 || percentile > 1)
+		throw std::invalid_argument("get_percentile");
+	/* report the highest value equivalent to the bucket holding the requested rank */
+	long target = (long) std::ceil(percentile * (double) this->total_count);
+	if (target < 1)
+		target = 1;
+	long cumulative = 0;
+	for (size_t i = 0; i < this->counts.size(); ++i) {
+		cumulative += this->counts[i];
+		if (cumulative >= target) {
+			long value = this->bucket_upper_bound((long) i);
+			value = std::min(value, this->max_value);
+			value = std::max(value, this->min_value);
+			return (double) value;
+		}
+	}
+	return (double) this->max_value;
+}
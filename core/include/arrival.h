@@ -0,0 +1,59 @@
+#ifndef YCSB_ARRIVAL_H
+#define YCSB_ARRIVAL_H
+
+#include <cstdint>
+#include <random>
+#include <string>
+
+enum ArrivalDistribution {
+	ARRIVAL_DETERMINISTIC = 0,
+	ARRIVAL_EXPONENTIAL,
+	ARRIVAL_UNIFORM,
+	NR_ARRIVAL_DISTRIBUTION,
+};
+
+extern const char *arrival_distribution_name[];
+
+/*
+ * gaps between the intended start times of one worker's ops
+ *
+ * the schedule is open loop: it never waits for ops to finish, a worker that
+ * falls behind sends its late ops at once and the lag is recorded. exponential
+ * gaps make each worker a poisson process, and n of them at rate r / n add up
+ * to one poisson process at rate r. uniform gaps are drawn from [0, 2 * mean].
+ */
+struct ArrivalProcess {
+	ArrivalDistribution distribution;
+	double mean_gap_ns;
+	std::mt19937_64 rng;
+	std::exponential_distribution<double> exponential;
+	std::uniform_real_distribution<double> uniform;
+	/* fraction of a ns carried to the next gap, so the rate holds for short gaps */
+	double carry_ns;
+
+	ArrivalProcess(ArrivalDistribution distribution, double mean_gap_ns, uint64_t seed);
+
+	/* gap in units of the mean gap, for schedules whose rate changes over time */
+	inline double next_unit_gap() {
+		switch (this->distribution) {
+		case ARRIVAL_EXPONENTIAL:
+			return this->exponential(this->rng);
+		case ARRIVAL_UNIFORM:
+			return this->uniform(this->rng) * 2;
+		default:
+			return 1;
+		}
+	}
+
+	inline long next_gap_ns() {
+		double gap_ns = this->next_unit_gap() * this->mean_gap_ns + this->carry_ns;
+		long whole_ns = (long) gap_ns;
+		this->carry_ns = gap_ns - (double) whole_ns;
+		return whole_ns;
+	}
+
+	/* throws std::invalid_argument on unknown names */
+	static ArrivalDistribution parse_distribution(const std::string &name);
+};
+
+#endif //YCSB_ARRIVAL_H
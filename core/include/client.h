@@ -2,11 +2,28 @@
 #define YCSB_CLIENT_H
 
 #include <atomic>
+#include <map>
 #include <stdexcept>
+#include <string>
+#include <vector>
 #include "workload.h"
 
 struct ClientFactory;
 
+/* background work reported by a backend, timestamp is on the Timer clock */
+struct BackendEvent {
+	long timestamp;
+	std::string name;
+	std::string detail;
+};
+
+/* one backend statistic, counters are cumulative and reported as deltas, gauges as sampled */
+struct BackendStat {
+	std::string name;
+	double value;
+	bool is_counter;
+};
+
 struct Client {
 	int id;
 	ClientFactory *factory;
@@ -22,6 +39,18 @@ struct Client {
 struct ClientFactory {
 	virtual Client *create_client() = 0;
 	virtual void destroy_client(Client *client) = 0;
+
+	/* polled by the monitor every epoch: events since the last call, and a short summary of the backend's state */
+	virtual void drain_events(std::vector<BackendEvent> *event_arr) {}
+	virtual std::string get_epoch_annotation() { return std::string(); }
+	/* engine statistics, sampled by the monitor every backend_stats_interval_seconds */
+	virtual void sample_stats(std::vector<BackendStat> *stat_arr) {}
+	/* true to have the monitor append each epoch's sample_stats (counters as deltas) to the epoch annotation */
+	virtual bool stats_in_epoch_annotation() { return false; }
+	/* file name -> group (e.g. "L2" for an sst) for the page-cache sampler */
+	virtual void get_file_groups(std::map<std::string, std::string> *file_group_map) {}
+	/* called once per phase (each repetition and probe) after its clients are destroyed */
+	virtual void report_phase(const char *phase_label) {}
 };
 
 #endif //YCSB_CLIENT_H
@@ -0,0 +1,43 @@
+#ifndef YCSB_HISTOGRAM_H
+#define YCSB_HISTOGRAM_H
+
+#include <vector>
+#include <cstdint>
+
+/*
+ * fixed-memory log-linear latency histogram (HDR-style)
+ *
+ * values below 2^precision_bits are counted exactly, larger values fall into
+ * one of 2^precision_bits linear sub-buckets per power of two, so the relative
+ * error of any reported value is bounded by 2^-precision_bits
+ */
+struct LatencyHistogram {
+	static constexpr int default_precision_bits = 7;
+	static constexpr int min_precision_bits = 1;
+	static constexpr int max_precision_bits = 16;
+
+	int precision_bits;
+	long sub_bucket_count;
+	std::vector<long> counts;
+	long total_count;
+	double total_sum;
+	long min_value;
+	long max_value;
+
+	explicit LatencyHistogram(int precision_bits = default_precision_bits);
+	void record(long value);
+	void merge(const LatencyHistogram &other);
+	void reset();
+
+	long get_count() const;
+	long get_min() const;
+	long get_max() const;
+	double get_average() const;
+	double get_percentile(double percentile) const;
+
+	long bucket_index(long value) const;
+	long bucket_lower_bound(long index) const;
+	long bucket_upper_bound(long index) const;
+};
+
+#endif //YCSB_HISTOGRAM_H
@@ -0,0 +1,51 @@
+#ifndef YCSB_KEY_SKETCH_H
+#define YCSB_KEY_SKETCH_H
+
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+/*
+ * fixed-memory summary of key popularity
+ *
+ * a count-min sketch estimates per-key access counts, the keys with the
+ * largest estimates are tracked as heavy hitters, and a HyperLogLog estimates
+ * the number of distinct keys. sketches of different threads merge exactly,
+ * so each worker keeps its own and they are combined after the run.
+ */
+struct KeySketch {
+	static constexpr int depth = 4;
+	static constexpr int width_bits = 14;
+	static constexpr long width = 1l << width_bits;
+	static constexpr int register_bits = 12;
+	static constexpr long nr_register = 1l << register_bits;
+
+	int top_key_capacity;
+	long total_count;
+	std::vector<uint64_t> count_arr;  /* depth rows of width counters */
+	std::vector<uint8_t> register_arr;
+	/* heavy hitters: a min-heap of (estimate, key) and each tracked key's position in it */
+	std::vector<std::pair<uint64_t, unsigned long>> top_key_heap;
+	std::unordered_map<unsigned long, size_t> top_key_index_map;
+
+	explicit KeySketch(int top_key_capacity);
+	void record(unsigned long key);
+	void merge(const KeySketch &other);
+
+	uint64_t estimate_count(unsigned long key) const;
+	double estimate_distinct_keys() const;
+	/* heavy hitters, most accessed first */
+	std::vector<std::pair<unsigned long, uint64_t>> get_top_keys() const;
+	void print_report(const char *task, int nr_top_key_printed) const;
+
+private:
+	static uint64_t mix(uint64_t value);
+	void update_top_key(unsigned long key, uint64_t estimate);
+	void sift_top_key_up(size_t index);
+	void sift_top_key_down(size_t index);
+	void swap_top_key(size_t a, size_t b);
+};
+
+#endif //YCSB_KEY_SKETCH_H
@@ -0,0 +1,91 @@
+#ifndef YCSB_LATENCY_LOG_H
+#define YCSB_LATENCY_LOG_H
+
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <thread>
+#include <vector>
+
+/*
+ * binary per-op latency log
+ *
+ * the file starts with a LatencyLogFileHeader, followed by chunks. each chunk is
+ * a LatencyLogChunkHeader and nr_record LatencyLogRecords of a single client.
+ * a record stores its timestamp as the delta to the previous record of the same
+ * chunk (the first one to base_timestamp), so chunks can be decoded on their own
+ * and may appear in any order. timestamps are ns since the start of the phase.
+ */
+#define LATENCY_LOG_MAGIC 0x594353424c415401ul  /* bump the low byte on layout changes */
+#define LATENCY_LOG_FLAG_LATENCY_US 0x1  /* latency did not fit in 32 bits of ns */
+
+struct __attribute__((packed)) LatencyLogFileHeader {
+	uint64_t magic;
+	uint32_t record_size;
+	uint32_t reserved;
+};
+
+struct __attribute__((packed)) LatencyLogChunkHeader {
+	uint64_t base_timestamp;
+	uint32_t nr_record;
+	uint16_t client_id;
+	uint16_t reserved;
+};
+
+struct __attribute__((packed)) LatencyLogRecord {
+	uint32_t timestamp_delta;
+	uint16_t client_id;
+	uint8_t op_type;
+	uint8_t flags;
+	uint32_t latency;
+};
+
+/* double-buffered record buffer of a single client, filled only by its worker */
+struct LatencyLogBuffer {
+	static constexpr long nr_record_per_buffer = 16384;
+
+	int client_id;
+	std::vector<LatencyLogRecord> record_arr[2];
+	uint64_t chunk_base_arr[2];
+	long nr_record_arr[2];
+	/* set by the worker when a buffer is handed to the flusher, cleared once written */
+	std::atomic<bool> full_arr[2];
+	int active;
+	long last_timestamp;
+	/* hand-offs on which the worker had to wait for the flusher */
+	long nr_stall;
+
+	explicit LatencyLogBuffer(int client_id);
+	void append(long timestamp, int op_type, long latency);
+
+private:
+	void hand_off();
+};
+
+/* streams the buffers of all clients to one file from a background thread */
+struct LatencyLogWriter {
+	FILE *file;
+	std::string path;
+	std::vector<LatencyLogBuffer *> buffer_list;
+	std::thread flush_thread;
+	std::atomic<bool> stopped;
+	/* set on the first short write, later chunks are dropped instead of written after a gap */
+	bool write_failed;
+	long nr_record_written;
+
+	explicit LatencyLogWriter(const char *path);
+	~LatencyLogWriter();
+	LatencyLogBuffer *add_client(int client_id);
+	void start();
+	/* call once all writers are done: stops the flusher and writes what is left */
+	void finish();
+
+private:
+	void flush_thread_fn();
+	bool flush_full_buffers();
+	void write_chunk(LatencyLogBuffer *buffer, int index);
+	void report_write_failure();
+};
+
+#endif //YCSB_LATENCY_LOG_H
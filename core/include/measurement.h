@@ -2,7 +2,16 @@
 #define YCSB_MEASUREMENT_H
 
 #include "workload.h"
-#include "avl_tree.h"
+#include "histogram.h"
+#include "measurement_config.h"
+#include "phaser.h"
+#include "latency_log.h"
+#include "timer.h"
+#include "perf_counter.h"
+#include "resource_usage.h"
+#include "page_cache.h"
+#include "tracer.h"
+#include "rate_schedule.h"
 #include <chrono>
 #include <atomic>
 #include <mutex>
@@ -10,47 +19,178 @@
 #include <list>
 #include <array>
 #include <vector>
+#include <string>
 #include <algorithm>
 #include <numeric>
 #include <cstdio>
 
 
-struct OpMeasurement {
+/* one op kept by the slowest-op capture, with enough context to find it again */
+struct SlowOp {
+	OperationType type;
+	std::string key;
+	long value_size;
+	int client_id;
+	/* Timer ns when the op was issued */
+	long start_timestamp;
+	long latency;
+};
+
+/*
+ * per-client measurement slot, written only by the worker that owns the client
+ * and padded to its own cache lines so workers never share a line
+ */
+struct alignas(64) ClientMeasurement {
 	std::atomic<long> op_count_arr[NR_OP_TYPE];
+	std::atomic<long> progress;
+	std::vector<LatencyHistogram> latency_hist;
+	/* records requested by the client's SCAN ops */
+	long scan_record_count;
+
+	/* response time from the intended start, only with coordinated omission correction */
+	std::vector<LatencyHistogram> response_hist;
+	long late_op_count;
+	long max_schedule_lag;
+	double total_schedule_lag;
+
+	/* hardware counters of the owning worker, only with perf_counters */
+	PerfCounterGroup *perf_counter;
+	uint64_t perf_counter_arr[NR_PERF_COUNTER];
+	uint64_t perf_counter_op_start[NR_PERF_COUNTER];
+	uint64_t perf_counter_op_arr[NR_OP_TYPE][NR_PERF_COUNTER];
+
+	/* getrusage of the owning worker at phase start, and its delta over the phase */
+	ThreadUsage thread_usage_start;
+	ThreadUsage thread_usage;
+
+	/* latency per popularity class, only when the workload ranks its keys */
+	std::vector<LatencyHistogram> popularity_hist;
+
+	/* min-heap of the slowest ops on latency, slow_op_threshold is its root once full */
+	std::vector<SlowOp> slow_op_heap;
+	int slow_op_capacity;
+	long slow_op_threshold;
+
+	/* per-epoch histograms, double-buffered so the monitor can swap them out */
+	WriterReaderPhaser interval_phaser;
+	std::vector<LatencyHistogram> interval_hist_arr[2];
+
+	/* per-op log stream, only when a latency file is requested */
+	LatencyLogBuffer *latency_log_buffer;
+
+	/* spans of sampled ops, only when a trace file is requested */
+	TraceRing *trace_ring;
+	long nr_op_since_trace;
+
+	explicit ClientMeasurement(const MeasurementConfig &config);
+};
+
+struct OpMeasurement {
 	std::chrono::steady_clock::time_point start_time;
 	std::chrono::steady_clock::time_point end_time;
+	/* start_time on the Timer clock, base of per-op timestamps */
+	long start_timestamp;
 
-	std::atomic<long> rt_op_count_arr[NR_OP_TYPE];
+	/* op counts seen by the last get_rt_throughput, only touched by the monitor */
+	long rt_op_count_arr[NR_OP_TYPE];
 	std::chrono::steady_clock::time_point rt_time;
 
 	long max_progress;
-	std::atomic<long> cur_progress;
+	/* key_size + value_size, the logical bytes one op reads or writes */
+	long record_size;
+	/* block device behind config.data_dir, if there is one */
+	bool has_io_device;
+	unsigned int io_device_major;
+	unsigned int io_device_minor;
+	std::string io_device_name;
+	/* i/o over the phase, the start samples are taken when the last client starts */
+	ProcessIoUsage process_io_start;
+	ProcessIoUsage process_io;
+	DeviceIoUsage device_io_start;
+	DeviceIoUsage device_io;
+	/* largest process rss the monitor saw, only touched by the monitor */
+	long max_rss_kb;
+	/* residency of data_dir in the page cache, owned by the phase runner, nullptr when disabled */
+	PageCacheSampler *page_cache_sampler;
 	std::atomic<bool> finished;
+	/* elects the last client to start, which takes the start samples */
+	std::atomic<int> nr_started_client;
 	std::atomic<int> nr_active_client;
 	std::mutex final_result_lock;
 
-	std::unordered_map<int, std::vector<double>[NR_OP_TYPE]> per_client_latency_vec;
-	std::unordered_map<int, std::vector<long>[NR_OP_TYPE]> per_client_timestamp_vec;
-	std::vector<double> final_latency_vec[NR_OP_TYPE];
+	MeasurementConfig config;
+	bool record_response_time;
+	/* open-loop target rate over all clients, 0 when the schedule is closed loop */
+	double target_ops_per_sec;
+	/* shared pacer of a rate schedule, owned by the phase runner, nullptr without one */
+	RatePacer *rate_pacer;
+	int nr_client;
+	/* indexed directly by client id, nullptr for clients of other phases */
+	std::vector<ClientMeasurement *> client_slot_arr;
+	std::vector<LatencyHistogram> final_latency_hist;
+	std::vector<LatencyHistogram> final_response_hist;
+	/* first rank past each popularity class but the last, empty when ops carry no rank */
+	std::vector<long> popularity_rank_limit_arr;
+	std::vector<LatencyHistogram> final_popularity_hist;
+	/* slowest ops of all clients, slowest first */
+	std::vector<SlowOp> final_slow_op_arr;
+	LatencyLogWriter *latency_log;
+	Tracer *tracer;
 
-	OpMeasurement();
+	explicit OpMeasurement(const MeasurementConfig &config);
+	~OpMeasurement();
 	void enable_client(int client_id);
 	void set_max_progress(long new_max_progress);
+	void set_next_op_interval(long next_op_interval_ns);
+	void set_target_rate(double new_target_ops_per_sec);
+	void set_rate_pacer(RatePacer *new_rate_pacer);
+	void set_record_size(long new_record_size);
+	void set_popularity_range(long nr_ranked_key);
 
-	void start_measure();
-	void finish_measure();
+	void start_measure(int id);
+	void finish_measure(int id);
 	void finalize_measure();
 
-	void record_op(OperationType type, double latency, int id);
-	void record_progress(long progress_delta);
+	void record_op(OperationType type, double latency, int id, long timestamp, long popularity_rank);
+	void record_response(OperationType type, double response_time, double schedule_lag, int id);
+	void record_progress(long progress_delta, int id);
+	void record_scan(long nr_record, int id);
+	/* the only check on the fast path, record_slow_op does the rest */
+	inline bool is_slow_op(long latency, int id) {
+		return latency > this->client_slot_arr[(unsigned long) id]->slow_op_threshold;
+	}
+	void record_slow_op(const Operation *op, long start_timestamp, long latency, int id);
+	/* true for every trace_sample_interval-th op of the client when tracing */
+	inline bool should_trace(int id) {
+		ClientMeasurement *slot = this->client_slot_arr[(unsigned long) id];
+		if (slot->trace_ring == nullptr || ++slot->nr_op_since_trace < this->config.trace_sample_interval)
+			return false;
+		slot->nr_op_since_trace = 0;
+		return true;
+	}
+	inline void trace_span(TraceSpan span, int op_type, long begin, long end, int id) {
+		this->client_slot_arr[(unsigned long) id]->trace_ring->record(span, op_type, begin, end);
+	}
+	void perf_op_begin(int id);
+	void perf_op_end(OperationType type, int id);
 
 	long get_op_count(OperationType type);
+	long get_scan_record_count();
 	double get_throughput(OperationType type);
+	/* target ops/s over all clients between two Timer timestamps, 0 in closed loop */
+	double get_target_throughput(long begin_timestamp, long end_timestamp);
 	void get_rt_throughput(double *throughput_arr);
+	void get_rt_latency(std::vector<LatencyHistogram> &hist_arr);
+	long get_progress();
 	double get_progress_percent();
+	ThreadUsage get_thread_usage();
+	DeviceIoUsage get_device_io_now();
+	uint64_t get_perf_counter(PerfCounterType counter);
+	uint64_t get_perf_counter(OperationType type, PerfCounterType counter);
 	double get_latency_average(OperationType type);
 	double get_latency_percentile(OperationType type, float percentile);
-	void save_latency(const char *path);
+	double get_response_average(OperationType type);
+	double get_response_percentile(OperationType type, float percentile);
 };
 
 #endif //YCSB_MEASUREMENT_H
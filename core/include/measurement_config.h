@@ -0,0 +1,85 @@
+#ifndef YCSB_MEASUREMENT_CONFIG_H
+#define YCSB_MEASUREMENT_CONFIG_H
+
+#include <string>
+#include <vector>
+#include "histogram.h"
+#include "rate_schedule.h"
+#include "slo_search.h"
+
+namespace YAML {
+class Node;
+}
+
+struct MeasurementConfig {
+	/* per-op latency dump, one file per phase named after the task, empty to disable */
+	std::string latency_file;
+	/* per-epoch throughput and latency time series (csv), empty to disable */
+	std::string timeline_file;
+	/* backend background events (flushes, compactions, stalls, ...) as csv, empty to disable */
+	std::string event_file;
+	/* per-interval deltas of engine statistics (csv), empty to disable */
+	std::string backend_stats_file;
+	int backend_stats_interval_seconds = 1;
+	/* with next_op_interval_ns pacing, also record latency from the intended start time */
+	bool correct_coordinated_omission = false;
+	/* open loop: global target rate split across workers, 0 keeps the fixed next_op_interval_ns schedule */
+	double target_ops_per_sec = 0;
+	/* gaps between intended start times in open loop: exponential (poisson), uniform or deterministic */
+	std::string arrival_distribution = "exponential";
+	/* open loop with a target rate that changes over the phase, excludes target_ops_per_sec */
+	RateSchedule rate_schedule;
+	/* replace the measured phase by probes that search for the highest rate meeting a latency slo */
+	SloSearchConfig slo_search;
+	/* time ops with a calibrated invariant TSC instead of steady_clock */
+	bool use_tsc = false;
+	/* per-worker hardware counters (perf_event_open), optionally split by op type */
+	bool perf_counters = false;
+	/*
+	 * costs two read() syscalls around every op, which slows the workers down even
+	 * though latencies leave them out, and counts user space only
+	 */
+	bool perf_counters_per_op_type = false;
+	/* directory whose block device is sampled for i/o stats, defaults to the backend's data_dir */
+	std::string data_dir;
+	/* page-cache residency of the files under data_dir, sampled every interval at idle priority, 0 to disable */
+	long page_cache_interval_ms = 0;
+	/* also split residency by file group (sst level where the backend knows it, else file extension) */
+	bool page_cache_by_group = false;
+	/* per-sample residency (csv), empty to only report it on the epoch line */
+	std::string page_cache_file;
+	/* chrome trace-event json of sampled ops, one file per phase named after the task, empty to disable */
+	std::string trace_file;
+	/* trace every trace_sample_interval-th op of each worker, keeping its latest trace_ring_size spans */
+	long trace_sample_interval = 100;
+	long trace_ring_size = 65536;
+	/* slowest ops kept per worker and dumped after the phase, 0 to disable */
+	int slow_op_count = 10;
+	/* heavy hitters tracked by the key popularity sketch of skewed workloads, 0 to disable, e.g. 1024 */
+	int key_sketch_top_k = 0;
+	/* upper bounds of the popularity classes as fractions of the ranked keys, a last class takes the rest */
+	std::vector<double> popularity_buckets = {0.001, 0.01, 0.1};
+	/* end the warm-up once throughput and p99 settle, warmup_runtime_seconds stays the limit */
+	bool warmup_until_steady = false;
+	/* epochs in the sliding window, and how many windows in a row must be stable */
+	int steady_state_window = 10;
+	int steady_state_stable_epochs = 5;
+	/* largest coefficient of variation (stddev / mean) a stable window may have */
+	double steady_state_max_cv = 0.05;
+	/* set per phase by for_phase, not parsed */
+	bool stop_at_steady_state = false;
+	/* times the measured phase runs on the same open database, summarized with 95% confidence intervals, not for trace workloads */
+	int repetitions = 1;
+	/* phase results with histograms appended here for compare_results, empty to disable */
+	std::string result_file;
+	/* log2 of linear sub-buckets per power of two in latency histograms */
+	int histogram_precision_bits = LatencyHistogram::default_precision_bits;
+
+	/* copy for one phase of a run, only the warm-up stops at steady state */
+	MeasurementConfig for_phase(bool is_warmup) const;
+
+	/* parse the optional "measurement" section of a run config */
+	static MeasurementConfig parse_yaml(YAML::Node &root);
+};
+
+#endif //YCSB_MEASUREMENT_CONFIG_H
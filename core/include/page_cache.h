@@ -0,0 +1,65 @@
+#ifndef YCSB_PAGE_CACHE_H
+#define YCSB_PAGE_CACHE_H
+
+#include <condition_variable>
+#include <cstdio>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include "client.h"
+
+/* page-cache residency of a group of files */
+struct PageCacheUsage {
+	long resident_bytes;
+	long total_bytes;
+
+	PageCacheUsage();
+};
+
+/*
+ * samples how much of the files under a directory sits in the page cache
+ *
+ * every interval_ms a SCHED_IDLE thread maps each file and asks mincore which
+ * pages are resident. mapping does not fault pages in, so the probe costs cpu
+ * but no i/o. "total" covers all files. with by_group, files are also counted
+ * per group: the factory's file groups (e.g. the level of an sst) first, then
+ * the file extension. looking up the file groups takes the engine's db mutex,
+ * so they are refreshed at normal priority by update_file_groups, from start()
+ * and the monitor, never from the SCHED_IDLE thread.
+ */
+struct PageCacheSampler {
+	std::string task;
+	std::string data_dir;
+	long interval_ms;
+	bool by_group;
+	ClientFactory *factory;
+	FILE *output_file;
+
+	std::thread thread;
+	std::mutex lock;
+	std::condition_variable cond;
+	bool stopping;
+	bool has_sample;
+	std::map<std::string, PageCacheUsage> last_usage_map;
+	/* file name -> group, as of the last update_file_groups */
+	std::map<std::string, std::string> group_map;
+
+	PageCacheSampler(const std::string &task, const std::string &data_dir, long interval_ms, bool by_group,
+	                 ClientFactory *factory, const std::string &output_file);
+	~PageCacheSampler();
+	void start();
+	void stop();
+	/* asks the factory for its file groups, call from a thread at normal priority */
+	void update_file_groups();
+	/* latest sample, false before the first one */
+	bool get_last_usage(std::map<std::string, PageCacheUsage> *usage_map);
+
+	static void sample(const std::string &data_dir, const std::map<std::string, std::string> *group_map,
+	                   std::map<std::string, PageCacheUsage> *usage_map);
+
+private:
+	void thread_fn();
+};
+
+#endif //YCSB_PAGE_CACHE_H
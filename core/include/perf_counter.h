@@ -0,0 +1,38 @@
+#ifndef YCSB_PERF_COUNTER_H
+#define YCSB_PERF_COUNTER_H
+
+#include <cstdint>
+
+enum PerfCounterType {
+	PERF_CYCLES = 0,
+	PERF_INSTRUCTIONS,
+	PERF_LLC_MISSES,
+	PERF_DTLB_MISSES,
+	PERF_BRANCH_MISSES,
+	NR_PERF_COUNTER,
+};
+
+extern const char *perf_counter_name[];
+
+/*
+ * hardware counter group of the calling thread, opened with perf_event_open
+ *
+ * cycles lead the group so all counters are scheduled together; counters the
+ * machine does not support are skipped and read as 0. values are scaled up when
+ * the kernel had to multiplex the group.
+ */
+struct PerfCounterGroup {
+	int fd_arr[NR_PERF_COUNTER];
+	uint64_t id_arr[NR_PERF_COUNTER];
+
+	PerfCounterGroup();
+	~PerfCounterGroup();
+	/* must be called from the thread to be measured, exclude_kernel counts user space only */
+	bool open(bool exclude_kernel = false);
+	void close();
+	void enable();
+	void disable();
+	bool read(uint64_t *value_arr);
+};
+
+#endif //YCSB_PERF_COUNTER_H
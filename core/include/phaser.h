@@ -0,0 +1,53 @@
+#ifndef YCSB_PHASER_H
+#define YCSB_PHASER_H
+
+#include <atomic>
+#include <climits>
+#include <thread>
+
+/*
+ * writer-reader phaser for double-buffered data (as in HdrHistogram's Recorder)
+ *
+ * writers bracket each update with writer_enter/writer_exit and write into the
+ * buffer returned by buffer_index; the reader calls flip_phase, which redirects
+ * new writers to the other buffer and waits for in-flight writers to leave the
+ * old one. writers never block, only a single reader may flip at a time.
+ */
+struct WriterReaderPhaser {
+	std::atomic<long> start_epoch{0};
+	std::atomic<long> even_end_epoch{0};
+	std::atomic<long> odd_end_epoch{LONG_MIN};
+
+	long writer_enter() {
+		return this->start_epoch.fetch_add(1);
+	}
+
+	void writer_exit(long critical_value) {
+		if (critical_value < 0)
+			this->odd_end_epoch.fetch_add(1);
+		else
+			this->even_end_epoch.fetch_add(1);
+	}
+
+	static int buffer_index(long critical_value) {
+		return critical_value < 0 ? 1 : 0;
+	}
+
+	/* returns the index of the buffer that is now quiescent and safe to read */
+	int flip_phase() {
+		bool next_phase_is_even = this->start_epoch.load() < 0;
+		long initial_start_value = next_phase_is_even ? 0 : LONG_MIN;
+		if (next_phase_is_even)
+			this->even_end_epoch.store(initial_start_value);
+		else
+			this->odd_end_epoch.store(initial_start_value);
+		long start_value_at_flip = this->start_epoch.exchange(initial_start_value);
+		std::atomic<long> &old_end_epoch = next_phase_is_even ? this->odd_end_epoch : this->even_end_epoch;
+		while (old_end_epoch.load() != start_value_at_flip) {
+			std::this_thread::yield();
+		}
+		return next_phase_is_even ? 1 : 0;
+	}
+};
+
+#endif //YCSB_PHASER_H
@@ -0,0 +1,114 @@
+#ifndef YCSB_RATE_SCHEDULE_H
+#define YCSB_RATE_SCHEDULE_H
+
+#include <atomic>
+#include <cmath>
+#include <string>
+#include <vector>
+#include "arrival.h"
+
+namespace YAML {
+class Node;
+}
+
+enum RateScheduleType {
+	RATE_SCHEDULE_NONE = 0,
+	RATE_SCHEDULE_RAMP,
+	RATE_SCHEDULE_STEP,
+	RATE_SCHEDULE_SINE,
+	RATE_SCHEDULE_CSV,
+	NR_RATE_SCHEDULE_TYPE,
+};
+
+extern const char *rate_schedule_type_name[];
+
+/* one point of a step or csv schedule */
+struct RatePoint {
+	double seconds;
+	double ops_per_sec;
+};
+
+/*
+ * target ops/s over all workers as a function of the time since the phase started
+ *
+ * ramp goes linearly from start_rate to end_rate over duration_seconds and then
+ * holds end_rate. step holds the rate of the latest point. sine oscillates
+ * around base_rate by amplitude with period_seconds. csv replays (seconds, ops/s)
+ * lines from a file, interpolated linearly between points. step and csv hold
+ * their first rate before the first point and their last rate after the last.
+ */
+struct RateSchedule {
+	RateScheduleType type = RATE_SCHEDULE_NONE;
+	double start_rate = 0;
+	double end_rate = 0;
+	double duration_seconds = 0;
+	double base_rate = 0;
+	double amplitude = 0;
+	double period_seconds = 0;
+	/* step points, or the points loaded from file, sorted by time */
+	std::vector<RatePoint> point_arr;
+	std::string file;
+	/* tokens the pacer may bank while workers fall behind, 0 never skips ops and sends them late instead */
+	long bucket_size = 0;
+
+	bool enabled() const {
+		return this->type != RATE_SCHEDULE_NONE;
+	}
+	double get_rate(double seconds) const;
+	/* mean rate over [begin_seconds, end_seconds] */
+	double get_average_rate(double begin_seconds, double end_seconds) const;
+
+	/* parse the optional "rate_schedule" node of the measurement section, loads csv files */
+	static RateSchedule parse_yaml(YAML::Node &node);
+};
+
+/*
+ * token bucket shared by all workers of a phase, refilled at the schedule's rate
+ *
+ * kept in its virtual-scheduling form: next_ns is when the next token becomes
+ * available and each acquire claims it with a cas, pushing next_ns one gap
+ * further. the gap is drawn from the worker's arrival process, so exponential
+ * gaps make the workers together a poisson process whose rate follows the
+ * schedule. with bucket_size, tokens older than bucket_size gaps are dropped
+ * and counted as skipped, otherwise late tokens are handed out at once.
+ */
+struct RatePacer {
+	RateSchedule schedule;
+	/* Timer ns the schedule's time counts from */
+	long start_ns;
+	std::atomic<long> next_ns;
+	std::atomic<long> nr_skipped;
+
+	explicit RatePacer(const RateSchedule &schedule);
+	/* restart the schedule at start_ns, call before the workers start */
+	void start(long new_start_ns);
+
+	inline double get_rate_at(long timestamp) const {
+		return this->schedule.get_rate((double) (timestamp - this->start_ns) / 1e9);
+	}
+
+	/* mean target ops/s between two Timer timestamps */
+	double get_average_rate(long begin_timestamp, long end_timestamp) const;
+
+	/* intended start time of the caller's next op */
+	inline long acquire(long now_ns, ArrivalProcess *arrival) {
+		double unit_gap = arrival->next_unit_gap();
+		long slot = this->next_ns.load(std::memory_order_relaxed);
+		long start, next;
+		do {
+			start = slot;
+			if (this->schedule.bucket_size > 0) {
+				long oldest = now_ns - std::lround((double) this->schedule.bucket_size * 1e9 / this->get_rate_at(now_ns));
+				if (start < oldest)
+					start = oldest;
+			}
+			next = start + std::lround(unit_gap * 1e9 / this->get_rate_at(start));
+		} while (!this->next_ns.compare_exchange_weak(slot, next, std::memory_order_relaxed));
+		if (start != slot)
+			this->nr_skipped.fetch_add(std::lround((double) (start - slot) * this->get_rate_at(slot) / 1e9),
+			                           std::memory_order_relaxed);
+		return start;
+	}
+};
+
+#endif //YCSB_RATE_SCHEDULE_H
@@ -0,0 +1,50 @@
+#ifndef YCSB_RESOURCE_USAGE_H
+#define YCSB_RESOURCE_USAGE_H
+
+#include <string>
+
+/* cpu time, context switches and page faults of one thread, from getrusage(RUSAGE_THREAD) */
+struct ThreadUsage {
+	long user_us;
+	long sys_us;
+	long nr_voluntary_switch;
+	long nr_involuntary_switch;
+	long nr_major_fault;
+	long nr_minor_fault;
+
+	ThreadUsage();
+	/* usage of the calling thread so far */
+	static ThreadUsage current();
+	ThreadUsage operator-(const ThreadUsage &other) const;
+	ThreadUsage &operator+=(const ThreadUsage &other);
+};
+
+/* storage bytes this process caused to be read or written, from /proc/self/io */
+struct ProcessIoUsage {
+	long read_bytes;
+	long write_bytes;
+
+	ProcessIoUsage();
+	static ProcessIoUsage current();
+	ProcessIoUsage operator-(const ProcessIoUsage &other) const;
+};
+
+/* completed requests and bytes of one block device, from /proc/diskstats */
+struct DeviceIoUsage {
+	long nr_read;
+	long read_bytes;
+	long nr_write;
+	long write_bytes;
+
+	DeviceIoUsage();
+	static DeviceIoUsage current(unsigned int device_major, unsigned int device_minor);
+	DeviceIoUsage operator-(const DeviceIoUsage &other) const;
+};
+
+/* block device holding path, false if none of /proc/diskstats backs it (tmpfs, overlay, ...) */
+bool find_block_device(const char *path, unsigned int *device_major, unsigned int *device_minor, std::string *name);
+
+/* resident set size of the whole process in KB, -1 if /proc is unavailable */
+long get_rss_kb();
+
+#endif //YCSB_RESOURCE_USAGE_H
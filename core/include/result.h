@@ -0,0 +1,46 @@
+#ifndef YCSB_RESULT_H
+#define YCSB_RESULT_H
+
+#include <cstdio>
+#include <istream>
+#include <string>
+#include <vector>
+#include "histogram.h"
+#include "workload.h"
+
+/*
+ * summary of one measured phase
+ *
+ * appended to measurement.result_file as a line-based text record, including
+ * the non-empty latency histogram buckets, so runs can be compared offline
+ */
+struct PhaseResult {
+	std::string task;
+	int repetition;
+	double duration;
+	double throughput_arr[NR_OP_TYPE];
+	std::vector<LatencyHistogram> latency_hist;
+	/* response time from the intended start when the phase recorded it, kept in memory only */
+	std::vector<LatencyHistogram> response_hist;
+
+	PhaseResult();
+	double get_total_throughput() const;
+	void save(FILE *file) const;
+	/* reads the next record, false at the end of the stream */
+	static bool load(std::istream &in, PhaseResult *result);
+};
+
+/* mean, sample standard deviation and 95% confidence half-width of repeated samples */
+struct SampleStats {
+	long count;
+	double mean;
+	double stddev;
+	double ci95;
+
+	explicit SampleStats(const std::vector<double> &value_arr);
+};
+
+/* two-sided 95% critical value of the student t distribution */
+double student_t_critical_95(double degrees_of_freedom);
+
+#endif //YCSB_RESULT_H
@@ -0,0 +1,66 @@
+#ifndef YCSB_SLO_SEARCH_H
+#define YCSB_SLO_SEARCH_H
+
+#include <functional>
+#include <string>
+#include <vector>
+#include "result.h"
+
+namespace YAML {
+class Node;
+}
+
+struct SloSearchConfig {
+	/* latency the percentile must stay under, 0 disables the search */
+	double latency_slo_ns = 0;
+	double percentile = 0.99;
+	/* first probe, and an upper bound on the rates tried (0: keep doubling until a probe fails) */
+	double min_rate = 1000;
+	double max_rate = 0;
+	long probe_seconds = 10;
+	/* stop once the gap between the best passing and the lowest failing rate is this fraction of it */
+	double precision = 0.05;
+	int max_probes = 20;
+	/* a probe that falls this far short of its target rate fails even if its latency is fine */
+	double min_achieved_ratio = 0.95;
+	/* latency-vs-load curve of all probes (csv), empty to only print it */
+	std::string curve_file;
+
+	bool enabled() const {
+		return this->latency_slo_ns > 0;
+	}
+
+	/* parse the optional "slo_search" node of the measurement section */
+	static SloSearchConfig parse_yaml(YAML::Node &node);
+};
+
+/* one probe phase of the search */
+struct SloProbe {
+	int probe;
+	double target_throughput;
+	double throughput;
+	/* latency at the configured percentile, and fixed percentiles for the curve */
+	double slo_latency;
+	double p50_latency;
+	double p99_latency;
+	double p999_latency;
+	bool passed;
+	/* the best passing probe below the lowest failing one */
+	bool is_knee;
+};
+
+/*
+ * searches for the highest open-loop rate that keeps the latency percentile under the slo
+ *
+ * run_probe runs one phase at the given target rate on the already open
+ * database. the rate doubles from min_rate until a probe fails, then the
+ * bracket between the best passing and the lowest failing rate shrinks by
+ * regula falsi on the measured percentiles, clamped to the inner 80% of the
+ * bracket so it keeps shrinking when the curve is far from linear. latency is
+ * the response time from the intended start, so queueing counts against the
+ * slo. returns all probes sorted by target rate.
+ */
+std::vector<SloProbe> search_max_throughput(const char *task, const SloSearchConfig &config,
+                                            const std::function<PhaseResult(double target_ops_per_sec, int probe)> &run_probe);
+
+#endif //YCSB_SLO_SEARCH_H
@@ -0,0 +1,31 @@
+#ifndef YCSB_STEADY_STATE_H
+#define YCSB_STEADY_STATE_H
+
+#include <deque>
+
+/*
+ * decides when per-epoch throughput and p99 latency have settled
+ *
+ * a window is stable when the coefficient of variation of both series is at
+ * most max_cv, steady state is reached after stable_epochs stable windows in a row
+ */
+struct SteadyStateDetector {
+	int window;
+	int stable_epochs;
+	double max_cv;
+
+	std::deque<double> throughput_window;
+	std::deque<double> latency_window;
+	int nr_stable_epoch;
+	double throughput_cv;
+	double latency_cv;
+
+	SteadyStateDetector(int window, int stable_epochs, double max_cv);
+	/* feeds one epoch, returns true once steady state is reached */
+	bool add_epoch(double throughput, double p99_latency);
+
+private:
+	static double coefficient_of_variation(const std::deque<double> &value_window);
+};
+
+#endif //YCSB_STEADY_STATE_H
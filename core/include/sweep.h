@@ -0,0 +1,55 @@
+#ifndef YCSB_SWEEP_H
+#define YCSB_SWEEP_H
+
+#include <string>
+#include <vector>
+#include "result.h"
+#include "workload.h"
+
+namespace YAML {
+class Node;
+}
+
+/* the workload settings of one measured phase, a point of the sweep matrix */
+struct SweepPoint {
+	int nr_thread;
+	struct OpProportion op_prop;
+	std::string request_distribution;
+	double zipfian_constant;
+	long next_op_interval_ns;
+
+	/* e.g. "nr_thread 8, read/update/insert/scan/rmw 0.5/0.5/0/0/0, zipfian 0.99, next_op_interval_ns 0" */
+	std::string describe() const;
+};
+
+/*
+ * values to sweep over in one run, from the optional "sweep" section
+ *
+ * the run mains measure every point of the cartesian product on the one open
+ * database, so the database is opened, settled and the zipfian zeta computed
+ * once per run instead of once per point. a dimension without values keeps the
+ * workload section's value, and uniform points skip the zipfian_constant axis.
+ */
+struct SweepConfig {
+	std::vector<int> nr_thread_list;
+	std::vector<struct OpProportion> operation_proportion_list;
+	std::vector<std::string> request_distribution_list;
+	std::vector<double> zipfian_constant_list;
+	std::vector<long> next_op_interval_ns_list;
+	/* warm up before every point instead of only before the first */
+	bool warmup_each_point = false;
+	/* one row per point (csv), empty to only print the table */
+	std::string table_file;
+
+	bool enabled() const;
+	/* points in run order, nr_thread varies fastest so scalability curves stay together */
+	std::vector<SweepPoint> expand(const SweepPoint &base_point) const;
+
+	static SweepConfig parse_yaml(YAML::Node &root);
+};
+
+/* prints one row per point, summarizing its phase results (repetitions, or the knee of an slo search) */
+void report_sweep(const char *task, const SweepConfig &config, const std::vector<SweepPoint> &point_arr,
+                  const std::vector<std::vector<PhaseResult>> &result_arr);
+
+#endif //YCSB_SWEEP_H
@@ -0,0 +1,53 @@
+#ifndef YCSB_TIMER_H
+#define YCSB_TIMER_H
+
+#include <chrono>
+#include <cstdint>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+/*
+ * nanosecond clock for the worker hot path
+ *
+ * with use_tsc and an invariant TSC, now_ns() reads rdtscp and scales it with
+ * a frequency calibrated against steady_clock, otherwise it falls back to
+ * steady_clock. both share the steady_clock epoch, so values can be mixed
+ * with steady_clock timestamps.
+ */
+struct Timer {
+	static bool tsc_enabled;
+	static double ns_per_tick;
+	static uint64_t base_tick;
+	static long base_ns;
+
+	/* calibrates once, later calls only switch between tsc and steady_clock */
+	static void init(bool use_tsc);
+	static bool has_invariant_tsc();
+
+	static inline long steady_now_ns() {
+		return std::chrono::duration_cast<std::chrono::nanoseconds>(
+			std::chrono::steady_clock::now().time_since_epoch()
+		).count();
+	}
+
+	static inline long now_ns() {
+#if defined(__x86_64__) || defined(__i386__)
+		if (tsc_enabled) {
+			unsigned int aux;
+			/* a core whose tsc lags the calibrating one reads slightly behind base_tick, not 2^64 ticks ahead */
+			int64_t nr_tick = (int64_t) (__rdtscp(&aux) - base_tick);
+			if (nr_tick < 0)
+				nr_tick = 0;
+			return base_ns + (long) ((double) nr_tick * ns_per_tick);
+		}
+#endif
+		return steady_now_ns();
+	}
+
+	static inline std::chrono::steady_clock::time_point to_time_point(long ns) {
+		return std::chrono::steady_clock::time_point(std::chrono::nanoseconds(ns));
+	}
+};
+
+#endif //YCSB_TIMER_H
@@ -0,0 +1,79 @@
+#ifndef YCSB_TRACER_H
+#define YCSB_TRACER_H
+
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+/* phases of worker_thread_fn that show up as spans */
+enum TraceSpan {
+	TRACE_NEXT_OP = 0,
+	TRACE_PACING,
+	TRACE_DO_OPERATION,
+	TRACE_RECORD_OP,
+	NR_TRACE_SPAN,
+};
+
+extern const char *trace_span_name[];
+
+struct TraceEvent {
+	long begin;
+	long end;
+	int16_t span;
+	int16_t op_type;
+};
+
+/*
+ * ring of the latest events of one worker
+ *
+ * only the owning worker writes and the tracer reads after the workers are
+ * joined, so the ring needs no locks or atomics. older events are overwritten.
+ */
+struct TraceRing {
+	int client_id;
+	std::vector<TraceEvent> event_arr;
+	uint64_t nr_event;
+
+	TraceRing(int client_id, long capacity);
+	inline void record(TraceSpan span, int op_type, long begin, long end) {
+		TraceEvent &event = this->event_arr[this->nr_event % this->event_arr.size()];
+		event.begin = begin;
+		event.end = end;
+		event.span = (int16_t) span;
+		event.op_type = (int16_t) op_type;
+		++this->nr_event;
+	}
+};
+
+/* instant event of the monitor, e.g. an epoch or a backend flush */
+struct TraceMarker {
+	long timestamp;
+	std::string name;
+	std::string detail;
+};
+
+/*
+ * sampled per-op tracer, exported as chrome trace-event json
+ *
+ * workers record spans of every sample_interval-th op into their own ring, the
+ * monitor adds markers. write_json emits "X" events per span and global "i"
+ * events per marker, with timestamps in us since the tracer was created.
+ */
+struct Tracer {
+	long base_timestamp;
+	long ring_capacity;
+	std::vector<TraceRing *> ring_list;
+	std::mutex marker_lock;
+	std::vector<TraceMarker> marker_arr;
+
+	explicit Tracer(long ring_capacity);
+	~Tracer();
+	/* not thread-safe, call while setting up clients */
+	TraceRing *add_client(int client_id);
+	void add_marker(long timestamp, const std::string &name, const std::string &detail);
+	/* call once all workers are joined */
+	bool write_json(const char *path, const char *task);
+};
+
+#endif //YCSB_TRACER_H
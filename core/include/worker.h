@@ -6,31 +6,37 @@
 #include <thread>
 #include <chrono>
 #include <list>
+#include <map>
 #include <string>
+#include <vector>
 #include "measurement.h"
 #include "client.h"
 #include "workload.h"
+#include "steady_state.h"
+#include "result.h"
+#include "arrival.h"
+#include "sweep.h"
 
-void worker_thread_fn(Client *client, Workload *workload, OpMeasurement *measurement, long next_op_interval_ns);
-void monitor_thread_fn(const char *task, OpMeasurement *measurement, long runtime_seconds);
+void worker_thread_fn(Client *client, Workload *workload, OpMeasurement *measurement, ArrivalProcess *arrival);
+void monitor_thread_fn(const char *task, ClientFactory *factory, OpMeasurement *measurement, long runtime_seconds);
 
-void run_workload_with_op_measurement(const char *task, ClientFactory *factory, Workload **workload_arr,
-                                      int nr_thread, long nr_op, long runtime_seconds, long max_progress, long next_op_interval_ns,
-                                      const char *latency_file);
+PhaseResult run_workload_with_op_measurement(const char *task, ClientFactory *factory, Workload **workload_arr,
+                                             int nr_thread, long nr_op, long runtime_seconds, long max_progress, long next_op_interval_ns,
+                                             const MeasurementConfig &measurement_config, int repetition = 0);
 void run_init_workload_with_op_measurement(const char *task, ClientFactory *factory, long nr_entry, long key_size, long value_size,
                                            int nr_thread);
-void run_uniform_workload_with_op_measurement(const char *task, ClientFactory *factory, long nr_entry, long key_size, long value_size,
-                                              long scan_length, int nr_thread, struct OpProportion op_prop, long nr_op, long runtime_seconds, long next_op_interval_ns,
-                                              const char *latency_file);
-void run_zipfian_workload_with_op_measurement(const char *task, ClientFactory *factory, long nr_entry, long key_size, long value_size,
-                                              long scan_length, int nr_thread, struct OpProportion op_prop, double zipfian_constant, long nr_op, long runtime_seconds, long next_op_interval_ns,
-                                              const char *latency_file);
-void run_latest_workload_with_op_measurement(const char *task, ClientFactory *factory, long nr_entry, long key_size, long value_size,
-                                             int nr_thread, double read_ratio, double zipfian_constant, long nr_op, long runtime_seconds, long next_op_interval_ns,
-                                             const char *latency_file);
+std::vector<PhaseResult> run_uniform_workload_with_op_measurement(const char *task, ClientFactory *factory, long nr_entry, long key_size, long value_size,
+                                                                  long scan_length, int nr_thread, struct OpProportion op_prop, long nr_op, long runtime_seconds, long next_op_interval_ns,
+                                                                  const MeasurementConfig &measurement_config);
+std::vector<PhaseResult> run_zipfian_workload_with_op_measurement(const char *task, ClientFactory *factory, long nr_entry, long key_size, long value_size,
+                                                                  long scan_length, int nr_thread, struct OpProportion op_prop, double zipfian_constant, long nr_op, long runtime_seconds, long next_op_interval_ns,
+                                                                  const MeasurementConfig &measurement_config);
+std::vector<PhaseResult> run_latest_workload_with_op_measurement(const char *task, ClientFactory *factory, long nr_entry, long key_size, long value_size,
+                                                                 int nr_thread, double read_ratio, double zipfian_constant, long nr_op, long runtime_seconds, long next_op_interval_ns,
+                                                                 const MeasurementConfig &measurement_config);
 void run_trace_workload_with_op_measurement(const char *task, ClientFactory *factory, long key_size, long value_size,
                                             int nr_thread, std::string trace_file, std::string trace_type, long runtime_seconds,
-                                            long next_op_interval_ns, const char *latency_file);
+                                            long next_op_interval_ns, const MeasurementConfig &measurement_config);
 
 void run_init_trace_workload_with_op_measurement(const char *task, ClientFactory *factory, long key_size, long value_size, std::string trace_file, std::string trace_type);
 #endif //YCSB_WORKER_H
@@ -15,6 +15,7 @@
 #include <vector>
 #include <mutex>
 #include <memory>
+#include "key_sketch.h"
 
 enum OperationType {
 	UPDATE = 0,
@@ -34,6 +35,7 @@ struct Operation {
 	long value_buffer_size;
 	char *reply_value_buffer;  /* for READ */
 	long scan_length;  /* for SCAN */
+	long popularity_rank;  /* 0 for the hottest key, -1 if the workload does not rank keys */
 	bool is_last_op;
 };
 
@@ -44,8 +46,10 @@ struct OpProportion {
 struct Workload {
 	long key_size;
 	long value_size;
-	bool record_keys = false;
-	std::vector<unsigned long> recorded_keys;
+	/* keys ranked by Operation::popularity_rank, 0 if ops carry no rank */
+	long nr_ranked_key = 0;
+	/* optional per-thread key popularity summary, owned by whoever attaches it */
+	KeySketch *key_sketch = nullptr;
 
 	Workload(long key_size, long value_size);
 	virtual void next_op(Operation *op) = 0;
@@ -0,0 +1,177 @@
+#include <cmath>
+#include <cstdio>
+#include <algorithm>
+#include "key_sketch.h"
+
+KeySketch::KeySketch(int top_key_capacity)
+: top_key_capacity(top_key_capacity), total_count(0), count_arr((unsigned long) (depth * width), 0),
+  register_arr((unsigned long) nr_register, 0) {}
+
+/* splitmix64 finalizer, rows use different seeds xor-ed into the key */
+uint64_t KeySketch::mix(uint64_t value) {
+	value += 0x9e3779b97f4a7c15ul;
+	value = (value ^ (value >> 30)) * 0xbf58476d1ce4e5b9ul;
+	value = (value ^ (value >> 27)) * 0x94d049bb133111ebul;
+	return value ^ (value >> 31);
+}
+
+void KeySketch::record(unsigned long key) {
+	++this->total_count;
+	uint64_t estimate = UINT64_MAX;
+	for (int row = 0; row < depth; ++row) {
+		uint64_t &count = this->count_arr[(unsigned long) (row * width) + (mix(key ^ ((uint64_t) row << 56)) >> (64 - width_bits))];
+		++count;
+		estimate = std::min(estimate, count);
+	}
+
+	/* first register_bits of the hash pick the register, the rest give the rank */
+	uint64_t hash = mix(key);
+	uint64_t index = hash >> (64 - register_bits);
+	uint64_t rest = hash << register_bits;
+	uint8_t rank = rest == 0 ? (uint8_t) (64 - register_bits + 1) : (uint8_t) (__builtin_clzl(rest) + 1);
+	if (rank > this->register_arr[index])
+		this->register_arr[index] = rank;
+
+	this->update_top_key(key, estimate);
+}
+
+void KeySketch::update_top_key(unsigned long key, uint64_t estimate) {
+	if (this->top_key_capacity <= 0)
+		return;
+	/*
+	 * estimates never decrease, so a key at or below the minimum of a full heap
+	 * is either untracked and stays out, or already tracked at that estimate.
+	 * most ops of a skewed workload hit tracked keys or end here without a lookup.
+	 */
+	bool full = (int) this->top_key_heap.size() == this->top_key_capacity;
+	if (full && estimate <= this->top_key_heap[0].first)
+		return;
+	auto it = this->top_key_index_map.find(key);
+	if (it != this->top_key_index_map.end()) {
+		this->top_key_heap[it->second].first = estimate;
+		this->sift_top_key_down(it->second);
+		return;
+	}
+	if (full) {
+		/* evict the minimum, the new key takes its slot at the root */
+		this->top_key_index_map.erase(this->top_key_heap[0].second);
+		this->top_key_index_map[key] = 0;
+		this->top_key_heap[0] = std::make_pair(estimate, key);
+		this->sift_top_key_down(0);
+		return;
+	}
+	this->top_key_index_map[key] = this->top_key_heap.size();
+	this->top_key_heap.push_back(std::make_pair(estimate, key));
+	this->sift_top_key_up(this->top_key_heap.size() - 1);
+}
+
+void KeySketch::sift_top_key_up(size_t index) {
+	while (index > 0 && this->top_key_heap[index].first < this->top_key_heap[(index - 1) / 2].first) {
+		this->swap_top_key(index, (index - 1) / 2);
+		index = (index - 1) / 2;
+	}
+}
+
+void KeySketch::sift_top_key_down(size_t index) {
+	size_t size = this->top_key_heap.size();
+	for (;;) {
+		size_t smallest = index;
+		size_t left = 2 * index + 1, right = 2 * index + 2;
+		if (left < size && this->top_key_heap[left].first < this->top_key_heap[smallest].first)
+			smallest = left;
+		if (right < size && this->top_key_heap[right].first < this->top_key_heap[smallest].first)
+			smallest = right;
+		if (smallest == index)
+			return;
+		this->swap_top_key(index, smallest);
+		index = smallest;
+	}
+}
+
+void KeySketch::swap_top_key(size_t a, size_t b) {
+	std::swap(this->top_key_heap[a], this->top_key_heap[b]);
+	this->top_key_index_map[this->top_key_heap[a].second] = a;
+	this->top_key_index_map[this->top_key_heap[b].second] = b;
+}
+
+void KeySketch::merge(const KeySketch &other) {
+	this->total_count += other.total_count;
+	for (size_t i = 0; i < this->count_arr.size(); ++i) {
+		this->count_arr[i] += other.count_arr[i];
+	}
+	for (size_t i = 0; i < this->register_arr.size(); ++i) {
+		this->register_arr[i] = std::max(this->register_arr[i], other.register_arr[i]);
+	}
+	/* candidates from both sides, re-estimated against the merged counters */
+	std::vector<unsigned long> candidate_arr;
+	for (auto &it : this->top_key_heap)
+		candidate_arr.push_back(it.second);
+	for (auto &it : other.top_key_heap)
+		candidate_arr.push_back(it.second);
+	this->top_key_heap.clear();
+	this->top_key_index_map.clear();
+	for (unsigned long key : candidate_arr) {
+		this->update_top_key(key, this->estimate_count(key));
+	}
+}
+
+uint64_t KeySketch::estimate_count(unsigned long key) const {
+	uint64_t estimate = UINT64_MAX;
+	for (int row = 0; row < depth; ++row) {
+		estimate = std::min(estimate, this->count_arr[(unsigned long) (row * width) + (mix(key ^ ((uint64_t) row << 56)) >> (64 - width_bits))]);
+	}
+	return estimate;
+}
+
+double KeySketch::estimate_distinct_keys() const {
+	double m = (double) nr_register;
+	double sum = 0;
+	long nr_zero_register = 0;
+	for (uint8_t rank : this->register_arr) {
+		sum += std::ldexp(1.0, -rank);
+		if (rank == 0)
+			++nr_zero_register;
+	}
+	double estimate = 0.7213 / (1 + 1.079 / m) * m * m / sum;
+	/* linear counting is more accurate while many registers are still empty */
+	if (estimate <= 2.5 * m && nr_zero_register > 0)
+		estimate = m * std::log(m / (double) nr_zero_register);
+	return estimate;
+}
+
+std::vector<std::pair<unsigned long, uint64_t>> KeySketch::get_top_keys() const {
+	std::vector<std::pair<unsigned long, uint64_t>> top_key_arr;
+	for (auto &it : this->top_key_heap) {
+		top_key_arr.push_back(std::make_pair(it.second, it.first));
+	}
+	std::sort(top_key_arr.begin(), top_key_arr.end(),
+	          [](const std::pair<unsigned long, uint64_t> &a, const std::pair<unsigned long, uint64_t> &b) {
+		return a.second > b.second || (a.second == b.second && a.first > b.first);
+	});
+	return top_key_arr;
+}
+
+void KeySketch::print_report(const char *task, int nr_top_key_printed) const {
+	if (this->total_count == 0)
+		return;
+	std::vector<std::pair<unsigned long, uint64_t>> top_key_arr = this->get_top_keys();
+	double distinct_keys = this->estimate_distinct_keys();
+	printf("%s key popularity: %ld accesses, ~%.0lf distinct keys, %zu heavy hitters tracked\n",
+	       task, this->total_count, distinct_keys, top_key_arr.size());
+
+	/* share of the hottest 1% / 10% of accessed keys, a lower bound once it exceeds what is tracked */
+	const double fraction_arr[] = {0.01, 0.1};
+	for (double fraction : fraction_arr) {
+		unsigned long nr_key = (unsigned long) std::ceil(fraction * distinct_keys);
+		unsigned long nr_summed = std::min(nr_key, (unsigned long) top_key_arr.size());
+		uint64_t accesses = 0;
+		for (unsigned long i = 0; i < nr_summed; ++i)
+			accesses += top_key_arr[i].second;
+		printf("%s key popularity: top %.0lf%% (%lu keys) get %s%.2lf%% of accesses\n", task, 100 * fraction, nr_key,
+		       nr_summed < nr_key ? ">= " : "", 100 * (double) accesses / (double) this->total_count);
+	}
+	for (int i = 0; i < nr_top_key_printed && i < (int) top_key_arr.size(); ++i) {
+		printf("%s key popularity: #%d key %lu ~%lu accesses (%.3lf%%)\n", task, i, top_key_arr[(unsigned long) i].first,
+		       top_key_arr[(unsigned long) i].second, 100 * (double) top_key_arr[(unsigned long) i].second / (double) this->total_count);
+	}
+}
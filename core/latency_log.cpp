@@ -0,0 +1,151 @@
+#include <algorithm>
+#include <chrono>
+#include <climits>
+#include <stdexcept>
+#include "latency_log.h"
+
+LatencyLogBuffer::LatencyLogBuffer(int client_id)
+: client_id(client_id), active(0), last_timestamp(0), nr_stall(0) {
+	for (int i = 0; i < 2; ++i) {
+		this->record_arr[i].resize(nr_record_per_buffer);
+		this->chunk_base_arr[i] = 0;
+		this->nr_record_arr[i] = 0;
+		this->full_arr[i] = false;
+	}
+}
+
+void LatencyLogBuffer::append(long timestamp, int op_type, long latency) {
+	/* deltas are unsigned, so a timestamp behind the phase start or the previous record is clamped to it */
+	timestamp = std::max(timestamp, 0l);
+	if (this->nr_record_arr[this->active] > 0)
+		timestamp = std::max(timestamp, this->last_timestamp);
+	long nr_record = this->nr_record_arr[this->active];
+	/* start a new chunk when the buffer is full or the delta would not fit */
+	if (nr_record == nr_record_per_buffer
+	    || (nr_record > 0 && timestamp - this->last_timestamp > (long) UINT32_MAX)) {
+		this->hand_off();
+		nr_record = 0;
+	}
+	if (nr_record == 0) {
+		this->chunk_base_arr[this->active] = (uint64_t) timestamp;
+		this->last_timestamp = timestamp;
+	}
+
+	LatencyLogRecord &record = this->record_arr[this->active][(unsigned long) nr_record];
+	record.timestamp_delta = (uint32_t) (timestamp - this->last_timestamp);
+	record.client_id = (uint16_t) this->client_id;
+	record.op_type = (uint8_t) op_type;
+	record.flags = 0;
+	if (latency > (long) UINT32_MAX) {
+		latency /= 1000;
+		record.flags |= LATENCY_LOG_FLAG_LATENCY_US;
+	}
+	record.latency = (uint32_t) std::min(latency, (long) UINT32_MAX);
+	this->last_timestamp = timestamp;
+	this->nr_record_arr[this->active] = nr_record + 1;
+}
+
+void LatencyLogBuffer::hand_off() {
+	this->full_arr[this->active].store(true, std::memory_order_release);
+	this->active ^= 1;
+	/* only blocks when the flusher fell a whole buffer behind */
+	if (this->full_arr[this->active].load(std::memory_order_acquire)) {
+		++this->nr_stall;
+		while (this->full_arr[this->active].load(std::memory_order_acquire))
+			std::this_thread::yield();
+	}
+	this->nr_record_arr[this->active] = 0;
+}
+
+LatencyLogWriter::LatencyLogWriter(const char *path)
+: path(path), stopped(false), write_failed(false), nr_record_written(0) {
+	this->file = fopen(path, "wb");
+	if (this->file == nullptr) {
+		fprintf(stderr, "LatencyLogWriter: failed to open latency file %s\n", path);
+		throw std::invalid_argument("failed to open latency file");
+	}
+	LatencyLogFileHeader header = {LATENCY_LOG_MAGIC, sizeof(LatencyLogRecord), 0};
+	if (fwrite(&header, sizeof(header), 1, this->file) != 1) {
+		fprintf(stderr, "LatencyLogWriter: failed to write latency file %s\n", path);
+		fclose(this->file);
+		this->file = nullptr;
+		throw std::invalid_argument("failed to write latency file");
+	}
+}
+
+LatencyLogWriter::~LatencyLogWriter() {
+	if (this->flush_thread.joinable())
+		this->finish();
+	for (LatencyLogBuffer *buffer : this->buffer_list) {
+		delete buffer;
+	}
+	if (this->file != nullptr)
+		fclose(this->file);
+}
+
+LatencyLogBuffer *LatencyLogWriter::add_client(int client_id) {
+	LatencyLogBuffer *buffer = new LatencyLogBuffer(client_id);
+	this->buffer_list.push_back(buffer);
+	return buffer;
+}
+
+void LatencyLogWriter::start() {
+	this->flush_thread = std::thread(&LatencyLogWriter::flush_thread_fn, this);
+}
+
+void LatencyLogWriter::finish() {
+	this->stopped.store(true);
+	if (this->flush_thread.joinable())
+		this->flush_thread.join();
+	this->flush_full_buffers();
+	/* writers are gone, their partially filled active buffers can be written directly */
+	for (LatencyLogBuffer *buffer : this->buffer_list) {
+		this->write_chunk(buffer, buffer->active);
+		buffer->nr_record_arr[buffer->active] = 0;
+	}
+	if (fflush(this->file) != 0)
+		this->report_write_failure();
+}
+
+void LatencyLogWriter::report_write_failure() {
+	/* e.g. a full disk, the log is truncated from here on */
+	if (!this->write_failed)
+		fprintf(stderr, "LatencyLogWriter: failed to write latency file %s, the log is truncated\n", this->path.c_str());
+	this->write_failed = true;
+}
+
+void LatencyLogWriter::flush_thread_fn() {
+	while (!this->stopped.load()) {
+		if (!this->flush_full_buffers())
+			std::this_thread::sleep_for(std::chrono::milliseconds(10));
+	}
+}
+
+bool LatencyLogWriter::flush_full_buffers() {
+	bool flushed = false;
+	for (LatencyLogBuffer *buffer : this->buffer_list) {
+		for (int i = 0; i < 2; ++i) {
+			if (!buffer->full_arr[i].load(std::memory_order_acquire))
+				continue;
+			this->write_chunk(buffer, i);
+			buffer->full_arr[i].store(false, std::memory_order_release);
+			flushed = true;
+		}
+	}
+	return flushed;
+}
+
+void LatencyLogWriter::write_chunk(LatencyLogBuffer *buffer, int index) {
+	long nr_record = buffer->nr_record_arr[index];
+	if (nr_record == 0)
+		return;
+	if (this->write_failed)
+		return;
+	LatencyLogChunkHeader header = {buffer->chunk_base_arr[index], (uint32_t) nr_record, (uint16_t) buffer->client_id, 0};
+	if (fwrite(&header, sizeof(header), 1, this->file) != 1
+	    || fwrite(buffer->record_arr[index].data(), sizeof(LatencyLogRecord), (size_t) nr_record, this->file) != (size_t) nr_record) {
+		this->report_write_failure();
+		return;
+	}
+	this->nr_record_written += nr_record;
+}
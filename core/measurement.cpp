@@ -1,83 +1,343 @@
+#include <cmath>
+#include <limits>
 #include "measurement.h"
 
-OpMeasurement::OpMeasurement() {
+/* orders the slowest-op heap so the fastest kept op is at the root */
+static bool slow_op_greater(const SlowOp &a, const SlowOp &b) {
+	return a.latency > b.latency;
+}
+
+ClientMeasurement::ClientMeasurement(const MeasurementConfig &config)
+: latency_hist(NR_OP_TYPE, LatencyHistogram(config.histogram_precision_bits)) {
+	this->interval_hist_arr[0] = this->latency_hist;
+	this->interval_hist_arr[1] = this->latency_hist;
 	for (int i = 0; i < NR_OP_TYPE; ++i) {
 		this->op_count_arr[i] = 0;
+	}
+	this->progress = 0;
+	this->scan_record_count = 0;
+	this->late_op_count = 0;
+	this->max_schedule_lag = 0;
+	this->total_schedule_lag = 0;
+	this->latency_log_buffer = nullptr;
+	this->trace_ring = nullptr;
+	this->nr_op_since_trace = 0;
+	this->perf_counter = nullptr;
+	this->slow_op_capacity = config.slow_op_count;
+	this->slow_op_threshold = config.slow_op_count > 0 ? -1 : std::numeric_limits<long>::max();
+	this->slow_op_heap.reserve((unsigned long) config.slow_op_count);
+	for (int i = 0; i < NR_PERF_COUNTER; ++i) {
+		this->perf_counter_arr[i] = 0;
+		this->perf_counter_op_start[i] = 0;
+		for (int j = 0; j < NR_OP_TYPE; ++j) {
+			this->perf_counter_op_arr[j][i] = 0;
+		}
+	}
+}
+
+OpMeasurement::OpMeasurement(const MeasurementConfig &config)
+: config(config), nr_client(0) {
+	for (int i = 0; i < NR_OP_TYPE; ++i) {
 		this->rt_op_count_arr[i] = 0;
 	}
-	this->cur_progress = 0;
 	this->finished = false;
 	this->final_result_lock.lock();
+	this->nr_started_client = 0;
 	this->nr_active_client = 0;
+	this->max_rss_kb = 0;
+	this->page_cache_sampler = nullptr;
+	this->record_size = 0;
+	this->has_io_device = false;
+	if (!config.data_dir.empty()) {
+		this->has_io_device = find_block_device(config.data_dir.c_str(), &this->io_device_major,
+		                                        &this->io_device_minor, &this->io_device_name);
+		if (!this->has_io_device)
+			fprintf(stderr, "OpMeasurement: no block device found for %s, reporting process i/o only\n", config.data_dir.c_str());
+	}
+	Timer::init(config.use_tsc);
+	this->start_timestamp = 0;
+	this->latency_log = nullptr;
+	if (!config.latency_file.empty())
+		this->latency_log = new LatencyLogWriter(config.latency_file.c_str());
+	this->tracer = nullptr;
+	if (!config.trace_file.empty())
+		this->tracer = new Tracer(config.trace_ring_size);
+	this->record_response_time = false;
+	this->target_ops_per_sec = 0;
+	this->rate_pacer = nullptr;
+	this->final_latency_hist.assign(NR_OP_TYPE, LatencyHistogram(config.histogram_precision_bits));
+	this->final_response_hist = this->final_latency_hist;
+}
+
+OpMeasurement::~OpMeasurement() {
+	for (ClientMeasurement *slot : this->client_slot_arr) {
+		delete slot;
+	}
+	delete this->latency_log;
+	delete this->tracer;
 }
 
 void OpMeasurement::enable_client(int client_id) {
-	/* trigger unordered_map allocation for client_id */
-	this->per_client_latency_vec[client_id][0].clear();
-	this->per_client_timestamp_vec[client_id][0].clear();
+	/* allocate all per-client state up front, record_op only indexes into it */
+	if (client_id >= (int) this->client_slot_arr.size())
+		this->client_slot_arr.resize((unsigned long) client_id + 1, nullptr);
+	delete this->client_slot_arr[(unsigned long) client_id];
+	ClientMeasurement *slot = new ClientMeasurement(this->config);
+	if (this->record_response_time)
+		slot->response_hist = slot->latency_hist;
+	if (!this->popularity_rank_limit_arr.empty())
+		slot->popularity_hist.assign(this->popularity_rank_limit_arr.size() + 1, LatencyHistogram(this->config.histogram_precision_bits));
+	if (this->latency_log != nullptr)
+		slot->latency_log_buffer = this->latency_log->add_client(client_id);
+	if (this->tracer != nullptr)
+		slot->trace_ring = this->tracer->add_client(client_id);
+	this->client_slot_arr[(unsigned long) client_id] = slot;
+	++this->nr_client;
 }
 
 void OpMeasurement::set_max_progress(long new_max_progress) {
 	this->max_progress = new_max_progress;
 }
 
-void OpMeasurement::start_measure() {
-	unsigned long total_nr_client = this->per_client_latency_vec.size();
-	int prev_nr_active_client = this->nr_active_client.fetch_add(1);
-	if (prev_nr_active_client == total_nr_client - 1) {
+void OpMeasurement::set_next_op_interval(long next_op_interval_ns) {
+	/* response time only differs from service time when ops are paced */
+	this->record_response_time = this->config.correct_coordinated_omission && next_op_interval_ns > 0;
+}
+
+void OpMeasurement::set_target_rate(double new_target_ops_per_sec) {
+	/* an open-loop schedule only makes sense measured from the intended start times */
+	this->target_ops_per_sec = new_target_ops_per_sec;
+	if (new_target_ops_per_sec > 0)
+		this->record_response_time = true;
+}
+
+void OpMeasurement::set_rate_pacer(RatePacer *new_rate_pacer) {
+	this->rate_pacer = new_rate_pacer;
+	if (new_rate_pacer != nullptr)
+		this->record_response_time = true;
+}
+
+void OpMeasurement::set_record_size(long new_record_size) {
+	this->record_size = new_record_size;
+}
+
+void OpMeasurement::set_popularity_range(long nr_ranked_key) {
+	this->popularity_rank_limit_arr.clear();
+	if (nr_ranked_key <= 0 || this->config.popularity_buckets.empty())
+		return;
+	for (double bound : this->config.popularity_buckets) {
+		/* every class holds at least the key at its first rank */
+		long limit = std::max((long) std::ceil(bound * (double) nr_ranked_key), 1l);
+		if (!this->popularity_rank_limit_arr.empty())
+			limit = std::max(limit, this->popularity_rank_limit_arr.back() + 1);
+		this->popularity_rank_limit_arr.push_back(limit);
+	}
+	this->final_popularity_hist.assign(this->popularity_rank_limit_arr.size() + 1, LatencyHistogram(this->config.histogram_precision_bits));
+}
+
+void OpMeasurement::start_measure(int id) {
+	this->client_slot_arr[(unsigned long) id]->thread_usage_start = ThreadUsage::current();
+	if (this->config.perf_counters) {
+		/* perf_event_open(pid = 0) counts the calling thread, so the worker opens its own group */
+		ClientMeasurement *slot = this->client_slot_arr[(unsigned long) id];
+		slot->perf_counter = new PerfCounterGroup();
+		/* per-op reads are syscalls themselves, keep their kernel work out of the deltas */
+		if (slot->perf_counter->open(this->config.perf_counters_per_op_type)) {
+			slot->perf_counter->enable();
+		} else {
+			delete slot->perf_counter;
+			slot->perf_counter = nullptr;
+		}
+	}
+	/* the last client to start sets the start samples before it publishes its own start */
+	int prev_nr_started_client = this->nr_started_client.fetch_add(1);
+	if (prev_nr_started_client == this->nr_client - 1) {
+		this->start_timestamp = Timer::now_ns();
 		this->start_time = std::chrono::steady_clock::now();
-		this->rt_time = std::chrono::steady_clock::now();
+		this->rt_time = this->start_time;
+		this->process_io_start = ProcessIoUsage::current();
+		this->device_io_start = this->get_device_io_now();
+		/* every client is registered by now, so the flusher may start walking them */
+		if (this->latency_log != nullptr)
+			this->latency_log->start();
 	}
+	/* a client that sees all clients active with an acquire load also sees start_timestamp */
+	this->nr_active_client.fetch_add(1, std::memory_order_release);
 }
 
-void OpMeasurement::finish_measure() {
-	unsigned long total_nr_client = this->per_client_latency_vec.size();
+void OpMeasurement::finish_measure(int id) {
+	ClientMeasurement *slot = this->client_slot_arr[(unsigned long) id];
+	if (slot->perf_counter != nullptr) {
+		slot->perf_counter->disable();
+		slot->perf_counter->read(slot->perf_counter_arr);
+		delete slot->perf_counter;
+		slot->perf_counter = nullptr;
+	}
+	slot->thread_usage = ThreadUsage::current() - slot->thread_usage_start;
 	int prev_nr_active_client = this->nr_active_client.fetch_sub(1);
-	if (prev_nr_active_client == total_nr_client) {
+	if (prev_nr_active_client == this->nr_client) {
 		this->finished.store(true);
 		this->end_time = std::chrono::steady_clock::now();
+		this->process_io = ProcessIoUsage::current() - this->process_io_start;
+		this->device_io = this->get_device_io_now() - this->device_io_start;
 	}
 }
 
 void OpMeasurement::finalize_measure() {
-	for (int i = 0; i < NR_OP_TYPE; ++i) {
-		for (const auto& client_vec : this->per_client_latency_vec) {
-			this->final_latency_vec[i].insert(this->final_latency_vec[i].end(), client_vec.second[i].begin(), client_vec.second[i].end());
+	/* O(clients * buckets), independent of the number of recorded ops */
+	for (size_t i = 0; i < NR_OP_TYPE; ++i) {
+		for (ClientMeasurement *slot : this->client_slot_arr) {
+			if (slot == nullptr)
+				continue;
+			this->final_latency_hist[i].merge(slot->latency_hist[i]);
+			if (this->record_response_time)
+				this->final_response_hist[i].merge(slot->response_hist[i]);
+		}
+	}
+	for (size_t i = 0; i < this->final_popularity_hist.size(); ++i) {
+		for (ClientMeasurement *slot : this->client_slot_arr) {
+			if (slot != nullptr)
+				this->final_popularity_hist[i].merge(slot->popularity_hist[i]);
+		}
+	}
+	for (ClientMeasurement *slot : this->client_slot_arr) {
+		if (slot != nullptr)
+			this->final_slow_op_arr.insert(this->final_slow_op_arr.end(), slot->slow_op_heap.begin(), slot->slow_op_heap.end());
+	}
+	std::sort(this->final_slow_op_arr.begin(), this->final_slow_op_arr.end(), slow_op_greater);
+	if (this->final_slow_op_arr.size() > (unsigned long) this->config.slow_op_count)
+		this->final_slow_op_arr.resize((unsigned long) this->config.slow_op_count);
+	if (this->latency_log != nullptr) {
+		this->latency_log->finish();
+		long nr_stall = 0;
+		for (LatencyLogBuffer *buffer : this->latency_log->buffer_list) {
+			nr_stall += buffer->nr_stall;
 		}
-		std::sort(this->final_latency_vec[i].begin(), this->final_latency_vec[i].end());
+		printf("OpMeasurement: wrote %ld records to latency file %s (%ld writer stalls)%s\n",
+		       this->latency_log->nr_record_written, this->config.latency_file.c_str(), nr_stall,
+		       this->latency_log->write_failed ? ", write failed, log truncated" : "");
 	}
 	this->final_result_lock.unlock();
 }
 
-void OpMeasurement::record_op(OperationType type, double latency, int id) {
-	if (this->per_client_latency_vec.size() != this->nr_active_client.load())
+void OpMeasurement::record_op(OperationType type, double latency, int id, long timestamp, long popularity_rank) {
+	if (this->nr_client != this->nr_active_client.load(std::memory_order_acquire))
 		return;
-	long duration = std::chrono::duration_cast<std::chrono::nanoseconds>(
-		std::chrono::steady_clock::now() - this->start_time
-	).count();
-	++this->op_count_arr[type];
-	++this->rt_op_count_arr[type];
-	this->per_client_latency_vec[id][type].push_back(latency);
-	this->per_client_timestamp_vec[id][type].push_back(duration);
+	ClientMeasurement *slot = this->client_slot_arr[(unsigned long) id];
+	/* single writer per slot: a relaxed load/store pair avoids a locked RMW */
+	slot->op_count_arr[type].store(slot->op_count_arr[type].load(std::memory_order_relaxed) + 1,
+	                               std::memory_order_relaxed);
+	slot->latency_hist[type].record((long) latency);
+	long critical_value = slot->interval_phaser.writer_enter();
+	slot->interval_hist_arr[WriterReaderPhaser::buffer_index(critical_value)][type].record((long) latency);
+	slot->interval_phaser.writer_exit(critical_value);
+	if (popularity_rank >= 0 && !slot->popularity_hist.empty()) {
+		size_t bucket = 0;
+		while (bucket < this->popularity_rank_limit_arr.size() && popularity_rank >= this->popularity_rank_limit_arr[bucket])
+			++bucket;
+		slot->popularity_hist[bucket].record((long) latency);
+	}
+	if (slot->latency_log_buffer != nullptr)
+		slot->latency_log_buffer->append(timestamp - this->start_timestamp, type, (long) latency);
+}
+
+void OpMeasurement::record_response(OperationType type, double response_time, double schedule_lag, int id) {
+	if (this->nr_client != this->nr_active_client.load(std::memory_order_relaxed))
+		return;
+	ClientMeasurement *slot = this->client_slot_arr[(unsigned long) id];
+	slot->response_hist[type].record((long) response_time);
+	if (schedule_lag > 0) {
+		++slot->late_op_count;
+		slot->total_schedule_lag += schedule_lag;
+		slot->max_schedule_lag = std::max(slot->max_schedule_lag, (long) schedule_lag);
+	}
+}
+
+void OpMeasurement::record_progress(long progress_delta, int id) {
+	ClientMeasurement *slot = this->client_slot_arr[(unsigned long) id];
+	slot->progress.store(slot->progress.load(std::memory_order_relaxed) + progress_delta,
+	                     std::memory_order_relaxed);
 }
 
-void OpMeasurement::record_progress(long progress_delta) {
-	this->cur_progress += progress_delta;
+void OpMeasurement::record_scan(long nr_record, int id) {
+	if (this->nr_client != this->nr_active_client.load(std::memory_order_relaxed))
+		return;
+	this->client_slot_arr[(unsigned long) id]->scan_record_count += nr_record;
+}
+
+void OpMeasurement::record_slow_op(const Operation *op, long start_timestamp, long latency, int id) {
+	if (this->nr_client != this->nr_active_client.load(std::memory_order_relaxed))
+		return;
+	ClientMeasurement *slot = this->client_slot_arr[(unsigned long) id];
+	std::vector<SlowOp> &heap = slot->slow_op_heap;
+	if ((int) heap.size() == slot->slow_op_capacity) {
+		std::pop_heap(heap.begin(), heap.end(), slow_op_greater);
+		heap.pop_back();
+	}
+	SlowOp slow_op;
+	slow_op.type = op->type;
+	slow_op.key = op->key_buffer;
+	bool has_value = op->type == UPDATE || op->type == INSERT || op->type == READ_MODIFY_WRITE;
+	slow_op.value_size = has_value ? op->value_buffer_size : 0;
+	slow_op.client_id = id;
+	slow_op.start_timestamp = start_timestamp;
+	slow_op.latency = latency;
+	heap.push_back(slow_op);
+	std::push_heap(heap.begin(), heap.end(), slow_op_greater);
+	if ((int) heap.size() == slot->slow_op_capacity)
+		slot->slow_op_threshold = heap.front().latency;
+}
+
+void OpMeasurement::perf_op_begin(int id) {
+	ClientMeasurement *slot = this->client_slot_arr[(unsigned long) id];
+	if (slot->perf_counter != nullptr)
+		slot->perf_counter->read(slot->perf_counter_op_start);
+}
+
+void OpMeasurement::perf_op_end(OperationType type, int id) {
+	ClientMeasurement *slot = this->client_slot_arr[(unsigned long) id];
+	if (slot->perf_counter == nullptr)
+		return;
+	uint64_t value_arr[NR_PERF_COUNTER];
+	slot->perf_counter->read(value_arr);
+	for (int i = 0; i < NR_PERF_COUNTER; ++i) {
+		slot->perf_counter_op_arr[type][i] += value_arr[i] - slot->perf_counter_op_start[i];
+	}
 }
 
 long OpMeasurement::get_op_count(OperationType type) {
-	return this->op_count_arr[type];
+	long op_count = 0;
+	for (ClientMeasurement *slot : this->client_slot_arr) {
+		if (slot != nullptr)
+			op_count += slot->op_count_arr[type].load(std::memory_order_relaxed);
+	}
+	return op_count;
+}
+
+long OpMeasurement::get_scan_record_count() {
+	long scan_record_count = 0;
+	for (ClientMeasurement *slot : this->client_slot_arr) {
+		if (slot != nullptr)
+			scan_record_count += slot->scan_record_count;
+	}
+	return scan_record_count;
 }
 
 double OpMeasurement::get_throughput(OperationType type) {
 	long duration = std::chrono::duration_cast<std::chrono::microseconds>(
 		this->end_time - this->start_time
 	).count();
-	return ((double) this->op_count_arr[type]) * 1000000 / duration;
+	return ((double) this->get_op_count(type)) * 1000000 / duration;
+}
+
+double OpMeasurement::get_target_throughput(long begin_timestamp, long end_timestamp) {
+	if (this->rate_pacer != nullptr)
+		return this->rate_pacer->get_average_rate(begin_timestamp, end_timestamp);
+	return this->target_ops_per_sec;
 }
 
 void OpMeasurement::get_rt_throughput(double *throughput_arr) {
-	if (this->per_client_latency_vec.size() != this->nr_active_client.load()) {
+	if (this->nr_client != this->nr_active_client.load()) {
 		/* not all the clients have started */
 		for (int i = 0; i < NR_OP_TYPE; ++i) {
 			throughput_arr[i] = 0;
@@ -89,57 +349,87 @@ void OpMeasurement::get_rt_throughput(double *throughput_arr) {
 		cur_time - this->rt_time
 	).count();
 	for (int i = 0; i < NR_OP_TYPE; ++i) {
-		throughput_arr[i] = ((double) this->rt_op_count_arr[i].exchange(0)) * 1000000 / duration;
+		long op_count = this->get_op_count((OperationType) i);
+		throughput_arr[i] = ((double) (op_count - this->rt_op_count_arr[i])) * 1000000 / duration;
+		this->rt_op_count_arr[i] = op_count;
 	}
 	this->rt_time = cur_time;
 }
 
-double OpMeasurement::get_progress_percent() {
-	return ((double) this->cur_progress) / ((double) this->max_progress);
+void OpMeasurement::get_rt_latency(std::vector<LatencyHistogram> &hist_arr) {
+	for (size_t i = 0; i < NR_OP_TYPE; ++i) {
+		hist_arr[i].reset();
+	}
+	for (ClientMeasurement *slot : this->client_slot_arr) {
+		if (slot == nullptr)
+			continue;
+		/* workers keep recording into the other buffer while this one is drained */
+		std::vector<LatencyHistogram> &interval_hist = slot->interval_hist_arr[slot->interval_phaser.flip_phase()];
+		for (size_t i = 0; i < NR_OP_TYPE; ++i) {
+			hist_arr[i].merge(interval_hist[i]);
+			interval_hist[i].reset();
+		}
+	}
 }
 
-double OpMeasurement::get_latency_average(OperationType type) {
-	if (this->final_latency_vec[type].empty()) {
-		return 0;
+long OpMeasurement::get_progress() {
+	long cur_progress = 0;
+	for (ClientMeasurement *slot : this->client_slot_arr) {
+		if (slot != nullptr)
+			cur_progress += slot->progress.load(std::memory_order_relaxed);
 	}
-	double latency_sum = std::accumulate(this->final_latency_vec[type].begin(), this->final_latency_vec[type].end(), 0.0);
-	return latency_sum / (double) this->final_latency_vec[type].size();
+	return cur_progress;
 }
 
-double OpMeasurement::get_latency_percentile(OperationType type, float percentile) {
-	if (this->final_latency_vec[type].empty()) {
-		return 0;
+double OpMeasurement::get_progress_percent() {
+	return ((double) this->get_progress()) / ((double) this->max_progress);
+}
+
+ThreadUsage OpMeasurement::get_thread_usage() {
+	ThreadUsage usage;
+	for (ClientMeasurement *slot : this->client_slot_arr) {
+		if (slot != nullptr)
+			usage += slot->thread_usage;
 	}
-	double exact_index = (double)(this->final_latency_vec[type].size() - 1) * percentile;
-	double left_index = floor(exact_index);
-	double right_index = ceil(exact_index);
+	return usage;
+}
 
-	double left_value = this->final_latency_vec[type][(unsigned long) left_index];
-	double right_value = this->final_latency_vec[type][(unsigned long) right_index];
+DeviceIoUsage OpMeasurement::get_device_io_now() {
+	if (!this->has_io_device)
+		return DeviceIoUsage();
+	return DeviceIoUsage::current(this->io_device_major, this->io_device_minor);
+}
 
-	double value = left_value + (exact_index - left_index) * (right_value - left_value);
+uint64_t OpMeasurement::get_perf_counter(PerfCounterType counter) {
+	uint64_t value = 0;
+	for (ClientMeasurement *slot : this->client_slot_arr) {
+		if (slot != nullptr)
+			value += slot->perf_counter_arr[counter];
+	}
 	return value;
 }
 
-void OpMeasurement::save_latency(const char *path) {
-	FILE *file = fopen(path, "w");
-	if (file == nullptr) {
-		fprintf(stderr, "OpMeasurement: failed to open latency file %s\n",
-		        path);
-		throw std::invalid_argument("failed to open latency file");
-	}
-	fprintf(file, "Timestamp (ns),Client ID,Operation,Latency (ns)\n");
-	for (auto& client_it : this->per_client_latency_vec) {
-		int id = client_it.first;
-		for (int op = 0; op < NR_OP_TYPE; ++op) {
-			for (size_t i = 0; i < this->per_client_latency_vec[id][op].size(); ++i) {
-				fprintf(file, "%ld,%d,%s,%f\n",
-				        this->per_client_timestamp_vec[id][op][i],
-				        id,
-				        operation_type_name[op],
-				        this->per_client_latency_vec[id][op][i]);
-			}
-		}
+uint64_t OpMeasurement::get_perf_counter(OperationType type, PerfCounterType counter) {
+	uint64_t value = 0;
+	for (ClientMeasurement *slot : this->client_slot_arr) {
+		if (slot != nullptr)
+			value += slot->perf_counter_op_arr[type][counter];
 	}
-	fclose(file);
+	return value;
+}
+
+double OpMeasurement::get_latency_average(OperationType type) {
+	return this->final_latency_hist[type].get_average();
+}
+
+double OpMeasurement::get_latency_percentile(OperationType type, float percentile) {
+	return this->final_latency_hist[type].get_percentile((double) percentile);
+}
+
+double OpMeasurement::get_response_average(OperationType type) {
+	return this->final_response_hist[type].get_average();
+}
+
+double OpMeasurement::get_response_percentile(OperationType type, float percentile) {
+	return this->final_response_hist[type].get_percentile((double) percentile);
 }
@@ -0,0 +1,129 @@
+#include <cstdio>
+#include <stdexcept>
+#include "measurement_config.h"
+#include "arrival.h"
+#include "yaml-cpp/yaml.h"
+
+MeasurementConfig MeasurementConfig::for_phase(bool is_warmup) const {
+	MeasurementConfig config = *this;
+	config.stop_at_steady_state = is_warmup && this->warmup_until_steady;
+	if (is_warmup) {
+		config.repetitions = 1;
+		config.slo_search.latency_slo_ns = 0;
+	}
+	return config;
+}
+
+MeasurementConfig MeasurementConfig::parse_yaml(YAML::Node &root) {
+	MeasurementConfig config;
+	YAML::Node measurement = root["measurement"];
+	if (!measurement)
+		return config;
+
+	if (measurement["latency_file"])
+		config.latency_file = measurement["latency_file"].as<std::string>();
+	if (measurement["timeline_file"])
+		config.timeline_file = measurement["timeline_file"].as<std::string>();
+	if (measurement["event_file"])
+		config.event_file = measurement["event_file"].as<std::string>();
+	if (measurement["backend_stats_file"])
+		config.backend_stats_file = measurement["backend_stats_file"].as<std::string>();
+	if (measurement["backend_stats_interval_seconds"])
+		config.backend_stats_interval_seconds = measurement["backend_stats_interval_seconds"].as<int>();
+	if (measurement["data_dir"])
+		config.data_dir = measurement["data_dir"].as<std::string>();
+	if (measurement["page_cache_interval_ms"])
+		config.page_cache_interval_ms = measurement["page_cache_interval_ms"].as<long>();
+	if (measurement["page_cache_by_group"])
+		config.page_cache_by_group = measurement["page_cache_by_group"].as<bool>();
+	if (measurement["page_cache_file"])
+		config.page_cache_file = measurement["page_cache_file"].as<std::string>();
+	if (measurement["trace_file"])
+		config.trace_file = measurement["trace_file"].as<std::string>();
+	if (measurement["trace_sample_interval"])
+		config.trace_sample_interval = measurement["trace_sample_interval"].as<long>();
+	if (measurement["trace_ring_size"])
+		config.trace_ring_size = measurement["trace_ring_size"].as<long>();
+	if (measurement["slow_op_count"])
+		config.slow_op_count = measurement["slow_op_count"].as<int>();
+	if (measurement["key_sketch_top_k"])
+		config.key_sketch_top_k = measurement["key_sketch_top_k"].as<int>();
+	if (measurement["popularity_buckets"])
+		config.popularity_buckets = measurement["popularity_buckets"].as<std::vector<double>>();
+	if (measurement["warmup_until_steady"])
+		config.warmup_until_steady = measurement["warmup_until_steady"].as<bool>();
+	if (measurement["steady_state_window"])
+		config.steady_state_window = measurement["steady_state_window"].as<int>();
+	if (measurement["steady_state_stable_epochs"])
+		config.steady_state_stable_epochs = measurement["steady_state_stable_epochs"].as<int>();
+	if (measurement["steady_state_max_cv"])
+		config.steady_state_max_cv = measurement["steady_state_max_cv"].as<double>();
+	if (measurement["repetitions"])
+		config.repetitions = measurement["repetitions"].as<int>();
+	if (measurement["result_file"])
+		config.result_file = measurement["result_file"].as<std::string>();
+	if (measurement["histogram_precision_bits"])
+		config.histogram_precision_bits = measurement["histogram_precision_bits"].as<int>();
+	if (measurement["correct_coordinated_omission"])
+		config.correct_coordinated_omission = measurement["correct_coordinated_omission"].as<bool>();
+	if (measurement["target_ops_per_sec"])
+		config.target_ops_per_sec = measurement["target_ops_per_sec"].as<double>();
+	if (measurement["arrival_distribution"])
+		config.arrival_distribution = measurement["arrival_distribution"].as<std::string>();
+	YAML::Node rate_schedule = measurement["rate_schedule"];
+	config.rate_schedule = RateSchedule::parse_yaml(rate_schedule);
+	YAML::Node slo_search = measurement["slo_search"];
+	config.slo_search = SloSearchConfig::parse_yaml(slo_search);
+	if (measurement["use_tsc"])
+		config.use_tsc = measurement["use_tsc"].as<bool>();
+	if (measurement["perf_counters"])
+		config.perf_counters = measurement["perf_counters"].as<bool>();
+	if (measurement["perf_counters_per_op_type"])
+		config.perf_counters_per_op_type = measurement["perf_counters_per_op_type"].as<bool>();
+
+	if (config.target_ops_per_sec < 0) {
+		fprintf(stderr, "MeasurementConfig: target_ops_per_sec must not be negative\n");
+		throw std::invalid_argument("invalid target_ops_per_sec");
+	}
+	ArrivalProcess::parse_distribution(config.arrival_distribution);
+	if (config.target_ops_per_sec > 0 && config.rate_schedule.enabled()) {
+		fprintf(stderr, "MeasurementConfig: set either target_ops_per_sec or rate_schedule\n");
+		throw std::invalid_argument("both target_ops_per_sec and rate_schedule set");
+	}
+	if (config.slo_search.enabled() && (config.target_ops_per_sec > 0 || config.rate_schedule.enabled())) {
+		fprintf(stderr, "MeasurementConfig: slo_search picks its own target rates, drop target_ops_per_sec and rate_schedule\n");
+		throw std::invalid_argument("slo_search with a fixed target rate");
+	}
+	if (config.backend_stats_interval_seconds < 1) {
+		fprintf(stderr, "MeasurementConfig: backend_stats_interval_seconds must be at least 1\n");
+		throw std::invalid_argument("invalid backend_stats_interval_seconds");
+	}
+	if (config.page_cache_interval_ms < 0) {
+		fprintf(stderr, "MeasurementConfig: page_cache_interval_ms must not be negative\n");
+		throw std::invalid_argument("invalid page_cache_interval_ms");
+	}
+	if (config.trace_sample_interval < 1 || config.trace_ring_size < 1) {
+		fprintf(stderr, "MeasurementConfig: trace_sample_interval and trace_ring_size must be at least 1\n");
+		throw std::invalid_argument("invalid trace_sample_interval or trace_ring_size");
+	}
+	if (config.slow_op_count < 0) {
+		fprintf(stderr, "MeasurementConfig: slow_op_count must not be negative\n");
+		throw std::invalid_argument("invalid slow_op_count");
+	}
+	if (config.repetitions < 1) {
+		fprintf(stderr, "MeasurementConfig: repetitions must be at least 1\n");
+		throw std::invalid_argument("invalid repetitions");
+	}
+	if (config.steady_state_window < 2 || config.steady_state_stable_epochs < 1 || config.steady_state_max_cv <= 0) {
+		fprintf(stderr, "MeasurementConfig: steady_state_window must be >= 2, steady_state_stable_epochs >= 1 and steady_state_max_cv > 0\n");
+		throw std::invalid_argument("invalid steady state detection");
+	}
+	for (size_t i = 0; i < config.popularity_buckets.size(); ++i) {
+		double bound = config.popularity_buckets[i];
+		if (bound <= 0 || bound >= 1 || (i > 0 && bound <= config.popularity_buckets[i - 1])) {
+			fprintf(stderr, "MeasurementConfig: popularity_buckets must be increasing fractions in (0, 1)\n");
+			throw std::invalid_argument("invalid popularity_buckets");
+		}
+	}
+	return config;
+}
@@ -0,0 +1,170 @@
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <stdexcept>
+#include <vector>
+#include <fcntl.h>
+#include <pthread.h>
+#include <sched.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/resource.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include "page_cache.h"
+#include "timer.h"
+
+/* bytes mapped per mincore call, bounds the residency vector */
+static const long page_cache_window_bytes = 1L << 30;
+
+PageCacheUsage::PageCacheUsage() : resident_bytes(0), total_bytes(0) {}
+
+/* resident bytes of an open file, -1 if it could not be mapped */
+static long count_resident_bytes(int fd, long file_size, long page_size, std::vector<unsigned char> *vec) {
+	long resident_bytes = 0;
+	for (long offset = 0; offset < file_size; offset += page_cache_window_bytes) {
+		size_t length = (size_t) std::min(page_cache_window_bytes, file_size - offset);
+		void *addr = mmap(nullptr, length, PROT_READ, MAP_SHARED, fd, offset);
+		if (addr == MAP_FAILED)
+			return -1;
+		size_t nr_page = (length + (size_t) page_size - 1) / (size_t) page_size;
+		vec->resize(nr_page);
+		if (mincore(addr, length, vec->data()) == 0) {
+			for (size_t i = 0; i < nr_page; ++i) {
+				if ((*vec)[i] & 1)
+					resident_bytes += page_size;
+			}
+		}
+		munmap(addr, length);
+	}
+	return std::min(resident_bytes, file_size);
+}
+
+static std::string file_group(const std::string &file_name, const std::map<std::string, std::string> *group_map) {
+	auto group_it = group_map->find(file_name);
+	if (group_it != group_map->end())
+		return group_it->second;
+	if (file_name.compare(0, 9, "MANIFEST-") == 0)
+		return "MANIFEST";
+	size_t dot = file_name.rfind('.');
+	return dot == std::string::npos ? "other" : file_name.substr(dot);
+}
+
+void PageCacheSampler::sample(const std::string &data_dir, const std::map<std::string, std::string> *group_map,
+                              std::map<std::string, PageCacheUsage> *usage_map) {
+	long page_size = sysconf(_SC_PAGESIZE);
+	std::vector<unsigned char> vec;
+	std::error_code ec;
+	PageCacheUsage &total = (*usage_map)["total"];
+	std::filesystem::recursive_directory_iterator it(data_dir, std::filesystem::directory_options::skip_permission_denied, ec);
+	for (; !ec && it != std::filesystem::recursive_directory_iterator(); it.increment(ec)) {
+		if (!it->is_regular_file(ec))
+			continue;
+		/* the engine deletes files under us all the time, skip what is gone */
+		int fd = open(it->path().c_str(), O_RDONLY | O_CLOEXEC);
+		if (fd < 0)
+			continue;
+		struct stat st;
+		if (fstat(fd, &st) == 0 && st.st_size > 0) {
+			long resident_bytes = count_resident_bytes(fd, (long) st.st_size, page_size, &vec);
+			if (resident_bytes >= 0) {
+				total.resident_bytes += resident_bytes;
+				total.total_bytes += (long) st.st_size;
+				if (group_map != nullptr) {
+					PageCacheUsage &usage = (*usage_map)[file_group(it->path().filename().string(), group_map)];
+					usage.resident_bytes += resident_bytes;
+					usage.total_bytes += (long) st.st_size;
+				}
+			}
+		}
+		close(fd);
+	}
+}
+
+PageCacheSampler::PageCacheSampler(const std::string &task, const std::string &data_dir, long interval_ms, bool by_group,
+                                   ClientFactory *factory, const std::string &output_file)
+	: task(task), data_dir(data_dir), interval_ms(interval_ms), by_group(by_group), factory(factory),
+	  output_file(nullptr), stopping(false), has_sample(false) {
+	if (!output_file.empty()) {
+		/* phases of one run append to the same file */
+		this->output_file = fopen(output_file.c_str(), "a");
+		if (this->output_file == nullptr) {
+			fprintf(stderr, "PageCacheSampler: failed to open %s\n", output_file.c_str());
+			throw std::invalid_argument("failed to open page cache file");
+		}
+		if (ftell(this->output_file) == 0)
+			fprintf(this->output_file, "Task,Elapsed (s),Group,Resident (bytes),Total (bytes),Resident (%%)\n");
+	}
+}
+
+PageCacheSampler::~PageCacheSampler() {
+	this->stop();
+	if (this->output_file != nullptr)
+		fclose(this->output_file);
+}
+
+void PageCacheSampler::start() {
+	this->stopping = false;
+	this->update_file_groups();
+	this->thread = std::thread(&PageCacheSampler::thread_fn, this);
+}
+
+void PageCacheSampler::stop() {
+	if (!this->thread.joinable())
+		return;
+	{
+		std::lock_guard<std::mutex> guard(this->lock);
+		this->stopping = true;
+	}
+	this->cond.notify_all();
+	this->thread.join();
+}
+
+void PageCacheSampler::update_file_groups() {
+	if (!this->by_group || this->factory == nullptr)
+		return;
+	std::map<std::string, std::string> new_group_map;
+	this->factory->get_file_groups(&new_group_map);
+	std::lock_guard<std::mutex> guard(this->lock);
+	this->group_map = std::move(new_group_map);
+}
+
+bool PageCacheSampler::get_last_usage(std::map<std::string, PageCacheUsage> *usage_map) {
+	std::lock_guard<std::mutex> guard(this->lock);
+	if (!this->has_sample)
+		return false;
+	*usage_map = this->last_usage_map;
+	return true;
+}
+
+void PageCacheSampler::thread_fn() {
+	/* only run when the cpu has nothing better to do, so the probe does not distort the run */
+	struct sched_param param = {};
+	if (pthread_setschedparam(pthread_self(), SCHED_IDLE, &param) != 0)
+		setpriority(PRIO_PROCESS, (id_t) syscall(SYS_gettid), 19);
+	long start_ns = Timer::steady_now_ns();
+	std::map<std::string, std::string> group_map;
+	std::unique_lock<std::mutex> guard(this->lock);
+	while (!this->stopping) {
+		/* a copy, the sample runs without the lock */
+		if (this->by_group)
+			group_map = this->group_map;
+		guard.unlock();
+		std::map<std::string, PageCacheUsage> usage_map;
+		sample(this->data_dir, this->by_group ? &group_map : nullptr, &usage_map);
+		double elapsed = (double) (Timer::steady_now_ns() - start_ns) / 1e9;
+		if (this->output_file != nullptr) {
+			for (auto &usage_it : usage_map) {
+				const PageCacheUsage &usage = usage_it.second;
+				fprintf(this->output_file, "%s,%.3f,%s,%ld,%ld,%.2f\n", this->task.c_str(), elapsed, usage_it.first.c_str(),
+				        usage.resident_bytes, usage.total_bytes,
+				        usage.total_bytes > 0 ? 100 * (double) usage.resident_bytes / (double) usage.total_bytes : 0);
+			}
+			fflush(this->output_file);
+		}
+		guard.lock();
+		this->last_usage_map = std::move(usage_map);
+		this->has_sample = true;
+		this->cond.wait_for(guard, std::chrono::milliseconds(this->interval_ms), [this] { return this->stopping; });
+	}
+}
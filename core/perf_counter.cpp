@@ -0,0 +1,109 @@
+#include <cstdio>
+#include <cstring>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+#include "perf_counter.h"
+
+const char *perf_counter_name[] = {
+	"cycles", "instructions", "LLC-misses", "dTLB-misses", "branch-misses"
+};
+
+static const uint32_t perf_counter_type[] = {
+	PERF_TYPE_HARDWARE, PERF_TYPE_HARDWARE, PERF_TYPE_HARDWARE, PERF_TYPE_HW_CACHE, PERF_TYPE_HARDWARE
+};
+
+static const uint64_t perf_counter_config[] = {
+	PERF_COUNT_HW_CPU_CYCLES,
+	PERF_COUNT_HW_INSTRUCTIONS,
+	PERF_COUNT_HW_CACHE_MISSES,
+	PERF_COUNT_HW_CACHE_DTLB | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16),
+	PERF_COUNT_HW_BRANCH_MISSES,
+};
+
+static long perf_event_open(struct perf_event_attr *attr, pid_t pid, int cpu, int group_fd, unsigned long flags) {
+	return syscall(SYS_perf_event_open, attr, pid, cpu, group_fd, flags);
+}
+
+PerfCounterGroup::PerfCounterGroup() {
+	for (int i = 0; i < NR_PERF_COUNTER; ++i) {
+		this->fd_arr[i] = -1;
+		this->id_arr[i] = 0;
+	}
+}
+
+PerfCounterGroup::~PerfCounterGroup() {
+	this->close();
+}
+
+bool PerfCounterGroup::open(bool exclude_kernel) {
+	for (int i = 0; i < NR_PERF_COUNTER; ++i) {
+		struct perf_event_attr attr;
+		memset(&attr, 0, sizeof(attr));
+		attr.size = sizeof(attr);
+		attr.type = perf_counter_type[i];
+		attr.config = perf_counter_config[i];
+		attr.disabled = (i == PERF_CYCLES);  /* the leader starts the whole group */
+		attr.exclude_hv = 1;
+		attr.exclude_kernel = exclude_kernel ? 1 : 0;
+		attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_ID
+		                   | PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+		int fd = (int) perf_event_open(&attr, 0, -1, this->fd_arr[PERF_CYCLES], 0);
+		if (fd < 0) {
+			if (i == PERF_CYCLES) {
+				perror("PerfCounterGroup: perf_event_open for cycles failed");
+				return false;
+			}
+			fprintf(stderr, "PerfCounterGroup: %s not available, reporting 0\n", perf_counter_name[i]);
+			continue;
+		}
+		this->fd_arr[i] = fd;
+		ioctl(fd, PERF_EVENT_IOC_ID, &this->id_arr[i]);
+	}
+	ioctl(this->fd_arr[PERF_CYCLES], PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+	return true;
+}
+
+void PerfCounterGroup::close() {
+	for (int i = NR_PERF_COUNTER - 1; i >= 0; --i) {
+		if (this->fd_arr[i] >= 0)
+			::close(this->fd_arr[i]);
+		this->fd_arr[i] = -1;
+	}
+}
+
+void PerfCounterGroup::enable() {
+	if (this->fd_arr[PERF_CYCLES] >= 0)
+		ioctl(this->fd_arr[PERF_CYCLES], PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+}
+
+void PerfCounterGroup::disable() {
+	if (this->fd_arr[PERF_CYCLES] >= 0)
+		ioctl(this->fd_arr[PERF_CYCLES], PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+}
+
+bool PerfCounterGroup::read(uint64_t *value_arr) {
+	for (int i = 0; i < NR_PERF_COUNTER; ++i) {
+		value_arr[i] = 0;
+	}
+	if (this->fd_arr[PERF_CYCLES] < 0)
+		return false;
+	/* PERF_FORMAT_GROUP layout: nr, time_enabled, time_running, {value, id}[nr] */
+	uint64_t buffer[3 + 2 * NR_PERF_COUNTER];
+	if (::read(this->fd_arr[PERF_CYCLES], buffer, sizeof(buffer)) <= 0)
+		return false;
+	uint64_t nr = buffer[0];
+	double scale = 1;
+	if (buffer[2] != 0 && buffer[2] < buffer[1])
+		scale = (double) buffer[1] / (double) buffer[2];
+	for (uint64_t j = 0; j < nr; ++j) {
+		uint64_t value = buffer[3 + 2 * j];
+		uint64_t id = buffer[4 + 2 * j];
+		for (int i = 0; i < NR_PERF_COUNTER; ++i) {
+			if (this->fd_arr[i] >= 0 && this->id_arr[i] == id)
+				value_arr[i] = (uint64_t) ((double) value * scale);
+		}
+	}
+	return true;
+}
@@ -0,0 +1,168 @@
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include "rate_schedule.h"
+#include "yaml-cpp/yaml.h"
+
+const char *rate_schedule_type_name[] = {
+	"none", "ramp", "step", "sine", "csv"
+};
+
+/* midpoints the average rate is taken over, enough to follow a step or a period */
+static const int rate_average_nr_sample = 64;
+
+double RateSchedule::get_rate(double seconds) const {
+	switch (this->type) {
+	case RATE_SCHEDULE_RAMP:
+		if (seconds >= this->duration_seconds)
+			return this->end_rate;
+		if (seconds <= 0)
+			return this->start_rate;
+		return this->start_rate + (this->end_rate - this->start_rate) * seconds / this->duration_seconds;
+	case RATE_SCHEDULE_SINE:
+		return this->base_rate + this->amplitude * sin(2 * M_PI * seconds / this->period_seconds);
+	case RATE_SCHEDULE_STEP:
+	case RATE_SCHEDULE_CSV: {
+		/* first point after seconds */
+		auto next_it = std::upper_bound(this->point_arr.begin(), this->point_arr.end(), seconds,
+		                                [](double value, const RatePoint &point) { return value < point.seconds; });
+		if (next_it == this->point_arr.begin())
+			return next_it->ops_per_sec;
+		auto prev_it = next_it - 1;
+		if (next_it == this->point_arr.end() || this->type == RATE_SCHEDULE_STEP)
+			return prev_it->ops_per_sec;
+		return prev_it->ops_per_sec + (next_it->ops_per_sec - prev_it->ops_per_sec) * (seconds - prev_it->seconds)
+		                              / (next_it->seconds - prev_it->seconds);
+	}
+	default:
+		return 0;
+	}
+}
+
+double RateSchedule::get_average_rate(double begin_seconds, double end_seconds) const {
+	if (end_seconds <= begin_seconds)
+		return this->get_rate(begin_seconds);
+	double step = (end_seconds - begin_seconds) / rate_average_nr_sample;
+	double total = 0;
+	for (int i = 0; i < rate_average_nr_sample; ++i)
+		total += this->get_rate(begin_seconds + (i + 0.5) * step);
+	return total / rate_average_nr_sample;
+}
+
+/* "seconds,ops_per_sec" lines, blank lines, # comments and a header line are skipped */
+static void load_rate_points(const std::string &file, std::vector<RatePoint> *point_arr) {
+	std::ifstream input(file);
+	if (!input) {
+		fprintf(stderr, "RateSchedule: failed to open %s\n", file.c_str());
+		throw std::invalid_argument("failed to open rate schedule file");
+	}
+	std::string line;
+	long line_number = 0;
+	while (std::getline(input, line)) {
+		++line_number;
+		if (line.empty() || line[0] == '#')
+			continue;
+		std::replace(line.begin(), line.end(), ',', ' ');
+		std::istringstream fields(line);
+		RatePoint point;
+		if (!(fields >> point.seconds >> point.ops_per_sec)) {
+			if (point_arr->empty() && line_number == 1)
+				continue;
+			fprintf(stderr, "RateSchedule: %s:%ld is not a \"seconds,ops_per_sec\" line\n", file.c_str(), line_number);
+			throw std::invalid_argument("invalid rate schedule file");
+		}
+		point_arr->push_back(point);
+	}
+}
+
+RateSchedule RateSchedule::parse_yaml(YAML::Node &node) {
+	RateSchedule schedule;
+	if (!node)
+		return schedule;
+
+	std::string type = node["type"] ? node["type"].as<std::string>() : "";
+	for (int i = 0; i < NR_RATE_SCHEDULE_TYPE; ++i) {
+		if (type == rate_schedule_type_name[i])
+			schedule.type = (RateScheduleType) i;
+	}
+	if (type != rate_schedule_type_name[schedule.type]) {
+		fprintf(stderr, "RateSchedule: unknown type \"%s\", expected ramp, step, sine or csv\n", type.c_str());
+		throw std::invalid_argument("unknown rate schedule type");
+	}
+	if (node["start_rate"])
+		schedule.start_rate = node["start_rate"].as<double>();
+	if (node["end_rate"])
+		schedule.end_rate = node["end_rate"].as<double>();
+	if (node["duration_seconds"])
+		schedule.duration_seconds = node["duration_seconds"].as<double>();
+	if (node["base_rate"])
+		schedule.base_rate = node["base_rate"].as<double>();
+	if (node["amplitude"])
+		schedule.amplitude = node["amplitude"].as<double>();
+	if (node["period_seconds"])
+		schedule.period_seconds = node["period_seconds"].as<double>();
+	if (node["steps"]) {
+		for (auto &step : node["steps"].as<std::vector<std::vector<double>>>()) {
+			if (step.size() != 2) {
+				fprintf(stderr, "RateSchedule: steps must be [seconds, ops_per_sec] pairs\n");
+				throw std::invalid_argument("invalid rate schedule steps");
+			}
+			schedule.point_arr.push_back({step[0], step[1]});
+		}
+	}
+	if (node["file"])
+		schedule.file = node["file"].as<std::string>();
+	if (node["bucket_size"])
+		schedule.bucket_size = node["bucket_size"].as<long>();
+
+	/* every rate must be positive, a pacer at 0 ops/s would never hand out the next token */
+	bool valid = schedule.bucket_size >= 0;
+	switch (schedule.type) {
+	case RATE_SCHEDULE_RAMP:
+		valid = valid && schedule.start_rate > 0 && schedule.end_rate > 0 && schedule.duration_seconds > 0;
+		break;
+	case RATE_SCHEDULE_SINE:
+		valid = valid && schedule.base_rate > 0 && schedule.amplitude >= 0 && schedule.amplitude < schedule.base_rate
+		        && schedule.period_seconds > 0;
+		break;
+	case RATE_SCHEDULE_CSV:
+		if (schedule.file.empty()) {
+			fprintf(stderr, "RateSchedule: a csv schedule needs a file\n");
+			throw std::invalid_argument("missing rate schedule file");
+		}
+		schedule.point_arr.clear();
+		load_rate_points(schedule.file, &schedule.point_arr);
+		/* fall through */
+	case RATE_SCHEDULE_STEP:
+		valid = valid && !schedule.point_arr.empty();
+		for (size_t i = 0; i < schedule.point_arr.size(); ++i) {
+			valid = valid && schedule.point_arr[i].ops_per_sec > 0
+			        && (i == 0 || schedule.point_arr[i].seconds > schedule.point_arr[i - 1].seconds);
+		}
+		break;
+	default:
+		break;
+	}
+	if (!valid) {
+		fprintf(stderr, "RateSchedule: invalid %s schedule, rates must be positive and points increasing in time "
+		        "(ramp: start_rate, end_rate, duration_seconds; step: steps; sine: base_rate > amplitude, period_seconds; "
+		        "csv: file)\n", rate_schedule_type_name[schedule.type]);
+		throw std::invalid_argument("invalid rate schedule");
+	}
+	return schedule;
+}
+
+RatePacer::RatePacer(const RateSchedule &schedule) : schedule(schedule), start_ns(0), next_ns(0), nr_skipped(0) {}
+
+void RatePacer::start(long new_start_ns) {
+	this->start_ns = new_start_ns;
+	this->next_ns = new_start_ns;
+	this->nr_skipped = 0;
+}
+
+double RatePacer::get_average_rate(long begin_timestamp, long end_timestamp) const {
+	return this->schedule.get_average_rate((double) (begin_timestamp - this->start_ns) / 1e9,
+	                                       (double) (end_timestamp - this->start_ns) / 1e9);
+}
@@ -0,0 +1,149 @@
+#include <cstdio>
+#include <cstring>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/sysmacros.h>
+#include <sys/time.h>
+#include <sys/resource.h>
+#include "resource_usage.h"
+
+ThreadUsage::ThreadUsage()
+	: user_us(0), sys_us(0), nr_voluntary_switch(0), nr_involuntary_switch(0), nr_major_fault(0), nr_minor_fault(0) {}
+
+ThreadUsage ThreadUsage::current() {
+	ThreadUsage usage;
+	struct rusage ru;
+	if (getrusage(RUSAGE_THREAD, &ru) != 0) {
+		perror("ThreadUsage: getrusage failed");
+		return usage;
+	}
+	usage.user_us = ru.ru_utime.tv_sec * 1000000 + ru.ru_utime.tv_usec;
+	usage.sys_us = ru.ru_stime.tv_sec * 1000000 + ru.ru_stime.tv_usec;
+	usage.nr_voluntary_switch = ru.ru_nvcsw;
+	usage.nr_involuntary_switch = ru.ru_nivcsw;
+	usage.nr_major_fault = ru.ru_majflt;
+	usage.nr_minor_fault = ru.ru_minflt;
+	return usage;
+}
+
+ThreadUsage ThreadUsage::operator-(const ThreadUsage &other) const {
+	ThreadUsage usage;
+	usage.user_us = this->user_us - other.user_us;
+	usage.sys_us = this->sys_us - other.sys_us;
+	usage.nr_voluntary_switch = this->nr_voluntary_switch - other.nr_voluntary_switch;
+	usage.nr_involuntary_switch = this->nr_involuntary_switch - other.nr_involuntary_switch;
+	usage.nr_major_fault = this->nr_major_fault - other.nr_major_fault;
+	usage.nr_minor_fault = this->nr_minor_fault - other.nr_minor_fault;
+	return usage;
+}
+
+ThreadUsage &ThreadUsage::operator+=(const ThreadUsage &other) {
+	this->user_us += other.user_us;
+	this->sys_us += other.sys_us;
+	this->nr_voluntary_switch += other.nr_voluntary_switch;
+	this->nr_involuntary_switch += other.nr_involuntary_switch;
+	this->nr_major_fault += other.nr_major_fault;
+	this->nr_minor_fault += other.nr_minor_fault;
+	return *this;
+}
+
+ProcessIoUsage::ProcessIoUsage() : read_bytes(0), write_bytes(0) {}
+
+ProcessIoUsage ProcessIoUsage::current() {
+	ProcessIoUsage usage;
+	FILE *file = fopen("/proc/self/io", "r");
+	if (file == nullptr)
+		return usage;
+	char name[64];
+	long value;
+	while (fscanf(file, "%63s %ld", name, &value) == 2) {
+		if (strcmp(name, "read_bytes:") == 0)
+			usage.read_bytes = value;
+		else if (strcmp(name, "write_bytes:") == 0)
+			usage.write_bytes = value;
+	}
+	fclose(file);
+	return usage;
+}
+
+ProcessIoUsage ProcessIoUsage::operator-(const ProcessIoUsage &other) const {
+	ProcessIoUsage usage;
+	usage.read_bytes = this->read_bytes - other.read_bytes;
+	usage.write_bytes = this->write_bytes - other.write_bytes;
+	return usage;
+}
+
+DeviceIoUsage::DeviceIoUsage() : nr_read(0), read_bytes(0), nr_write(0), write_bytes(0) {}
+
+DeviceIoUsage DeviceIoUsage::current(unsigned int device_major, unsigned int device_minor) {
+	DeviceIoUsage usage;
+	FILE *file = fopen("/proc/diskstats", "r");
+	if (file == nullptr)
+		return usage;
+	/* major minor name reads merged sectors ms writes merged sectors ..., sectors are always 512 bytes */
+	char line[512];
+	while (fgets(line, sizeof(line), file) != nullptr) {
+		unsigned int cur_major, cur_minor;
+		long nr_read, nr_read_merged, nr_read_sector, read_ms, nr_write, nr_write_merged, nr_write_sector;
+		if (sscanf(line, "%u %u %*s %ld %ld %ld %ld %ld %ld %ld", &cur_major, &cur_minor, &nr_read, &nr_read_merged,
+		           &nr_read_sector, &read_ms, &nr_write, &nr_write_merged, &nr_write_sector) != 9)
+			continue;
+		if (cur_major != device_major || cur_minor != device_minor)
+			continue;
+		usage.nr_read = nr_read;
+		usage.read_bytes = nr_read_sector * 512;
+		usage.nr_write = nr_write;
+		usage.write_bytes = nr_write_sector * 512;
+		break;
+	}
+	fclose(file);
+	return usage;
+}
+
+DeviceIoUsage DeviceIoUsage::operator-(const DeviceIoUsage &other) const {
+	DeviceIoUsage usage;
+	usage.nr_read = this->nr_read - other.nr_read;
+	usage.read_bytes = this->read_bytes - other.read_bytes;
+	usage.nr_write = this->nr_write - other.nr_write;
+	usage.write_bytes = this->write_bytes - other.write_bytes;
+	return usage;
+}
+
+bool find_block_device(const char *path, unsigned int *device_major, unsigned int *device_minor, std::string *name) {
+	struct stat st;
+	if (stat(path, &st) != 0)
+		return false;
+	FILE *file = fopen("/proc/diskstats", "r");
+	if (file == nullptr)
+		return false;
+	char line[512];
+	char cur_name[256];
+	bool found = false;
+	while (fgets(line, sizeof(line), file) != nullptr) {
+		unsigned int cur_major, cur_minor;
+		if (sscanf(line, "%u %u %255s", &cur_major, &cur_minor, cur_name) != 3)
+			continue;
+		if (cur_major == major(st.st_dev) && cur_minor == minor(st.st_dev)) {
+			*device_major = cur_major;
+			*device_minor = cur_minor;
+			*name = cur_name;
+			found = true;
+			break;
+		}
+	}
+	fclose(file);
+	return found;
+}
+
+long get_rss_kb() {
+	/* statm: size resident shared text lib data dt, in pages */
+	FILE *file = fopen("/proc/self/statm", "r");
+	if (file == nullptr)
+		return -1;
+	long nr_page, nr_resident_page;
+	int ret = fscanf(file, "%ld %ld", &nr_page, &nr_resident_page);
+	fclose(file);
+	if (ret != 2)
+		return -1;
+	return nr_resident_page * (sysconf(_SC_PAGESIZE) / 1024);
+}
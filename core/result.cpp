@@ -0,0 +1,135 @@
+#include <cmath>
+#include <cstring>
+#include <sstream>
+#include <stdexcept>
+#include "result.h"
+
+PhaseResult::PhaseResult() : repetition(0), duration(0) {
+	for (int i = 0; i < NR_OP_TYPE; ++i) {
+		this->throughput_arr[i] = 0;
+	}
+}
+
+double PhaseResult::get_total_throughput() const {
+	double total_throughput = 0;
+	for (int i = 0; i < NR_OP_TYPE; ++i) {
+		total_throughput += this->throughput_arr[i];
+	}
+	return total_throughput;
+}
+
+void PhaseResult::save(FILE *file) const {
+	fprintf(file, "phase\n");
+	fprintf(file, "task %s\n", this->task.c_str());
+	fprintf(file, "repetition %d\n", this->repetition);
+	fprintf(file, "duration %.6f\n", this->duration);
+	for (int i = 0; i < NR_OP_TYPE; ++i) {
+		fprintf(file, "throughput %s %.6f\n", operation_type_name[i], this->throughput_arr[i]);
+	}
+	/* histogram OP precision_bits count sum min max nr_bucket (index count)... */
+	for (size_t i = 0; i < this->latency_hist.size() && i < NR_OP_TYPE; ++i) {
+		const LatencyHistogram &hist = this->latency_hist[i];
+		long nr_bucket = 0;
+		for (long count : hist.counts) {
+			if (count != 0)
+				++nr_bucket;
+		}
+		fprintf(file, "histogram %s %d %ld %.0f %ld %ld %ld", operation_type_name[i], hist.precision_bits,
+		        hist.total_count, hist.total_sum, hist.min_value, hist.max_value, nr_bucket);
+		for (size_t index = 0; index < hist.counts.size(); ++index) {
+			if (hist.counts[index] != 0)
+				fprintf(file, " %zu %ld", index, hist.counts[index]);
+		}
+		fprintf(file, "\n");
+	}
+	fprintf(file, "end\n");
+}
+
+static int find_operation_type(const std::string &name) {
+	for (int i = 0; i < NR_OP_TYPE; ++i) {
+		if (name == operation_type_name[i])
+			return i;
+	}
+	return -1;
+}
+
+bool PhaseResult::load(std::istream &in, PhaseResult *result) {
+	std::string line;
+	while (std::getline(in, line) && line != "phase")
+		;
+	if (!in)
+		return false;
+	*result = PhaseResult();
+	while (std::getline(in, line) && line != "end") {
+		std::istringstream line_stream(line);
+		std::string field, op_name;
+		line_stream >> field;
+		if (field == "task") {
+			result->task = line.size() > 5 ? line.substr(5) : "";
+		} else if (field == "repetition") {
+			line_stream >> result->repetition;
+		} else if (field == "duration") {
+			line_stream >> result->duration;
+		} else if (field == "throughput") {
+			double throughput;
+			line_stream >> op_name >> throughput;
+			int type = find_operation_type(op_name);
+			if (type >= 0)
+				result->throughput_arr[type] = throughput;
+		} else if (field == "histogram") {
+			int precision_bits;
+			long nr_bucket;
+			line_stream >> op_name >> precision_bits;
+			int type = find_operation_type(op_name);
+			if (type < 0 || !line_stream)
+				throw std::invalid_argument("malformed histogram in result file");
+			if (result->latency_hist.empty())
+				result->latency_hist.assign(NR_OP_TYPE, LatencyHistogram(precision_bits));
+			LatencyHistogram &hist = result->latency_hist[(unsigned long) type];
+			if (hist.precision_bits != precision_bits)
+				hist = LatencyHistogram(precision_bits);
+			line_stream >> hist.total_count >> hist.total_sum >> hist.min_value >> hist.max_value >> nr_bucket;
+			for (long i = 0; i < nr_bucket; ++i) {
+				unsigned long index;
+				long count;
+				line_stream >> index >> count;
+				if (!line_stream || index >= hist.counts.size())
+					throw std::invalid_argument("malformed histogram in result file");
+				hist.counts[index] = count;
+			}
+		}
+	}
+	if (result->latency_hist.empty())
+		result->latency_hist.assign(NR_OP_TYPE, LatencyHistogram());
+	return true;
+}
+
+SampleStats::SampleStats(const std::vector<double> &value_arr)
+: count((long) value_arr.size()), mean(0), stddev(0), ci95(0) {
+	if (this->count == 0)
+		return;
+	for (double value : value_arr)
+		this->mean += value;
+	this->mean /= (double) this->count;
+	if (this->count < 2)
+		return;
+	double square_sum = 0;
+	for (double value : value_arr)
+		square_sum += (value - this->mean) * (value - this->mean);
+	this->stddev = std::sqrt(square_sum / (double) (this->count - 1));
+	this->ci95 = student_t_critical_95((double) (this->count - 1)) * this->stddev / std::sqrt((double) this->count);
+}
+
+double student_t_critical_95(double degrees_of_freedom) {
+	static const double critical_arr[] = {
+		12.706, 4.303, 3.182, 2.776, 2.571, 2.447, 2.365, 2.306, 2.262, 2.228,
+		2.201, 2.179, 2.160, 2.145, 2.131, 2.120, 2.110, 2.101, 2.093, 2.086,
+		2.080, 2.074, 2.069, 2.064, 2.060, 2.056, 2.052, 2.048, 2.045, 2.042,
+	};
+	if (degrees_of_freedom < 1)
+		return INFINITY;
+	if (degrees_of_freedom > 30)
+		return degrees_of_freedom > 120 ? 1.960 : 2.042 - (degrees_of_freedom - 30) * (2.042 - 1.980) / 90;
+	/* round fractional (welch) degrees of freedom down, which is conservative */
+	return critical_arr[(int) degrees_of_freedom - 1];
+}
@@ -0,0 +1,157 @@
+#include <algorithm>
+#include <cstdio>
+#include <stdexcept>
+#include "slo_search.h"
+#include "yaml-cpp/yaml.h"
+
+/* share of the bracket a regula falsi step must stay away from its ends */
+static const double slo_search_min_step = 0.1;
+/* how far below min_rate the search follows a failing first probe */
+static const double slo_search_min_rate_divisor = 1024;
+
+SloSearchConfig SloSearchConfig::parse_yaml(YAML::Node &node) {
+	SloSearchConfig config;
+	if (!node)
+		return config;
+
+	if (node["latency_slo_ns"])
+		config.latency_slo_ns = node["latency_slo_ns"].as<double>();
+	if (node["percentile"])
+		config.percentile = node["percentile"].as<double>();
+	if (node["min_rate"])
+		config.min_rate = node["min_rate"].as<double>();
+	if (node["max_rate"])
+		config.max_rate = node["max_rate"].as<double>();
+	if (node["probe_seconds"])
+		config.probe_seconds = node["probe_seconds"].as<long>();
+	if (node["precision"])
+		config.precision = node["precision"].as<double>();
+	if (node["max_probes"])
+		config.max_probes = node["max_probes"].as<int>();
+	if (node["min_achieved_ratio"])
+		config.min_achieved_ratio = node["min_achieved_ratio"].as<double>();
+	if (node["curve_file"])
+		config.curve_file = node["curve_file"].as<std::string>();
+
+	if (config.latency_slo_ns < 0 || config.percentile <= 0 || config.percentile >= 1 || config.min_rate <= 0
+	    || (config.max_rate != 0 && config.max_rate < config.min_rate) || config.probe_seconds < 1
+	    || config.precision <= 0 || config.precision >= 1 || config.max_probes < 2
+	    || config.min_achieved_ratio < 0 || config.min_achieved_ratio > 1) {
+		fprintf(stderr, "SloSearchConfig: need latency_slo_ns >= 0, 0 < percentile < 1, min_rate > 0, max_rate 0 or >= min_rate, "
+		        "probe_seconds >= 1, 0 < precision < 1, max_probes >= 2 and 0 <= min_achieved_ratio <= 1\n");
+		throw std::invalid_argument("invalid slo_search");
+	}
+	return config;
+}
+
+/* response time when the phase recorded it, service time otherwise, over all op types */
+static SloProbe evaluate_probe(const SloSearchConfig &config, const PhaseResult &result, double target_throughput, int probe) {
+	const std::vector<LatencyHistogram> &hist_arr = result.response_hist.empty() ? result.latency_hist : result.response_hist;
+	LatencyHistogram hist = hist_arr.empty() ? LatencyHistogram() : LatencyHistogram(hist_arr[0].precision_bits);
+	for (const LatencyHistogram &op_hist : hist_arr)
+		hist.merge(op_hist);
+
+	SloProbe slo_probe;
+	slo_probe.probe = probe;
+	slo_probe.target_throughput = target_throughput;
+	slo_probe.throughput = result.get_total_throughput();
+	slo_probe.slo_latency = hist.get_percentile(config.percentile);
+	slo_probe.p50_latency = hist.get_percentile(0.5);
+	slo_probe.p99_latency = hist.get_percentile(0.99);
+	slo_probe.p999_latency = hist.get_percentile(0.999);
+	slo_probe.passed = hist.get_count() > 0 && slo_probe.slo_latency <= config.latency_slo_ns
+	                   && slo_probe.throughput >= config.min_achieved_ratio * target_throughput;
+	slo_probe.is_knee = false;
+	return slo_probe;
+}
+
+static void write_curve(const char *task, const SloSearchConfig &config, const std::vector<SloProbe> &probe_arr) {
+	FILE *curve_file = fopen(config.curve_file.c_str(), "a");
+	if (curve_file == nullptr) {
+		fprintf(stderr, "search_max_throughput: failed to open curve file %s\n", config.curve_file.c_str());
+		return;
+	}
+	if (ftell(curve_file) == 0)
+		fprintf(curve_file, "Task,Probe,Target (ops/sec),Throughput (ops/sec),Percentile,Percentile Latency (ns),"
+		        "SLO (ns),P50 (ns),P99 (ns),P99.9 (ns),Passed,Knee\n");
+	for (const SloProbe &probe : probe_arr) {
+		fprintf(curve_file, "%s,%d,%.2f,%.2f,%g,%.0f,%.0f,%.0f,%.0f,%.0f,%d,%d\n", task, probe.probe,
+		        probe.target_throughput, probe.throughput, config.percentile, probe.slo_latency, config.latency_slo_ns,
+		        probe.p50_latency, probe.p99_latency, probe.p999_latency, probe.passed ? 1 : 0, probe.is_knee ? 1 : 0);
+	}
+	fclose(curve_file);
+}
+
+std::vector<SloProbe> search_max_throughput(const char *task, const SloSearchConfig &config,
+                                            const std::function<PhaseResult(double target_ops_per_sec, int probe)> &run_probe) {
+	std::vector<SloProbe> probe_arr;
+	/* best passing and lowest failing probe, the knee lies between them */
+	const SloProbe *pass = nullptr, *fail = nullptr;
+	double percentile = 100 * config.percentile;
+	double rate = config.max_rate > 0 ? std::min(config.min_rate, config.max_rate) : config.min_rate;
+	probe_arr.reserve((size_t) config.max_probes);
+
+	printf("%s slo search: p%g latency <= %.0lf ns, probes of %ld s from %.2lf ops/sec\n", task, percentile,
+	       config.latency_slo_ns, config.probe_seconds, rate);
+	for (int probe = 0; probe < config.max_probes; ++probe) {
+		probe_arr.push_back(evaluate_probe(config, run_probe(rate, probe), rate, probe));
+		const SloProbe &last = probe_arr.back();
+		printf("%s slo search (probe %d): target %.2lf ops/sec, achieved %.2lf ops/sec, p%g latency %.0lf ns, %s\n", task,
+		       probe, last.target_throughput, last.throughput, percentile, last.slo_latency, last.passed ? "pass" : "fail");
+		if (last.passed && (pass == nullptr || rate > pass->target_throughput))
+			pass = &last;
+		if (!last.passed && (fail == nullptr || rate < fail->target_throughput))
+			fail = &last;
+
+		if (fail == nullptr) {
+			/* still below the knee, double until a probe fails or max_rate holds */
+			if (config.max_rate > 0 && rate >= config.max_rate)
+				break;
+			rate *= 2;
+			if (config.max_rate > 0)
+				rate = std::min(rate, config.max_rate);
+		} else if (pass == nullptr) {
+			/* even the first rate fails, halve until one passes */
+			if (rate < config.min_rate / slo_search_min_rate_divisor)
+				break;
+			rate = fail->target_throughput / 2;
+		} else {
+			double low = pass->target_throughput, high = fail->target_throughput;
+			if (high - low <= config.precision * high)
+				break;
+			rate = (low + high) / 2;
+			/* a probe that failed on latency, not on throughput, says where the percentile crosses the slo */
+			if (fail->slo_latency > config.latency_slo_ns && fail->slo_latency > pass->slo_latency)
+				rate = low + (high - low) * (config.latency_slo_ns - pass->slo_latency) / (fail->slo_latency - pass->slo_latency);
+			rate = std::max(low + slo_search_min_step * (high - low), std::min(rate, high - slo_search_min_step * (high - low)));
+		}
+	}
+
+	/* sorting moves the probes under pass and fail, keep the rate of the lowest failing one */
+	double fail_rate = fail == nullptr ? 0 : fail->target_throughput;
+	std::sort(probe_arr.begin(), probe_arr.end(),
+	          [](const SloProbe &a, const SloProbe &b) { return a.target_throughput < b.target_throughput; });
+	SloProbe *knee = nullptr;
+	for (SloProbe &probe : probe_arr) {
+		printf("%s slo search curve: target %.2lf ops/sec, achieved %.2lf ops/sec, p50/p99/p99.9 latency %.0lf/%.0lf/%.0lf ns, "
+		       "p%g latency %.0lf ns, %s\n", task, probe.target_throughput, probe.throughput, probe.p50_latency,
+		       probe.p99_latency, probe.p999_latency, percentile, probe.slo_latency, probe.passed ? "pass" : "fail");
+		if (probe.passed && (fail_rate == 0 || probe.target_throughput < fail_rate))
+			knee = &probe;
+	}
+	if (knee != nullptr)
+		knee->is_knee = true;
+	if (knee == nullptr)
+		printf("%s slo search: no probe kept p%g latency under %.0lf ns, the lowest rate tried was %.2lf ops/sec\n", task,
+		       percentile, config.latency_slo_ns, probe_arr.front().target_throughput);
+	else if (fail_rate == 0)
+		printf("%s slo search: every probe passed, max sustainable throughput is at least %.2lf ops/sec (p%g latency %.0lf ns)\n",
+		       task, knee->throughput, percentile, knee->slo_latency);
+	else
+		printf("%s slo search: max sustainable throughput %.2lf ops/sec (target %.2lf ops/sec, p%g latency %.0lf ns), "
+		       "knee between %.2lf and %.2lf ops/sec\n", task, knee->throughput, knee->target_throughput, percentile,
+		       knee->slo_latency, knee->target_throughput, fail_rate);
+	if (!config.curve_file.empty())
+		write_curve(task, config, probe_arr);
+	return probe_arr;
+}
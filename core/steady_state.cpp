@@ -0,0 +1,36 @@
+#include <cmath>
+#include "steady_state.h"
+
+SteadyStateDetector::SteadyStateDetector(int window, int stable_epochs, double max_cv)
+: window(window), stable_epochs(stable_epochs), max_cv(max_cv), nr_stable_epoch(0), throughput_cv(0), latency_cv(0) {}
+
+double SteadyStateDetector::coefficient_of_variation(const std::deque<double> &value_window) {
+	double sum = 0;
+	for (double value : value_window)
+		sum += value;
+	double mean = sum / (double) value_window.size();
+	if (mean == 0)
+		return INFINITY;
+	double square_sum = 0;
+	for (double value : value_window)
+		square_sum += (value - mean) * (value - mean);
+	return std::sqrt(square_sum / (double) value_window.size()) / mean;
+}
+
+bool SteadyStateDetector::add_epoch(double throughput, double p99_latency) {
+	this->throughput_window.push_back(throughput);
+	this->latency_window.push_back(p99_latency);
+	if ((int) this->throughput_window.size() > this->window) {
+		this->throughput_window.pop_front();
+		this->latency_window.pop_front();
+	}
+	if ((int) this->throughput_window.size() < this->window)
+		return false;
+	this->throughput_cv = coefficient_of_variation(this->throughput_window);
+	this->latency_cv = coefficient_of_variation(this->latency_window);
+	if (this->throughput_cv <= this->max_cv && this->latency_cv <= this->max_cv)
+		++this->nr_stable_epoch;
+	else
+		this->nr_stable_epoch = 0;
+	return this->nr_stable_epoch >= this->stable_epochs;
+}
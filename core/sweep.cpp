@@ -0,0 +1,186 @@
+#include <cstdio>
+#include <stdexcept>
+#include "sweep.h"
+#include "yaml-cpp/yaml.h"
+
+std::string SweepPoint::describe() const {
+	char buffer[256];
+	int length = snprintf(buffer, sizeof(buffer), "nr_thread %d, read/update/insert/scan/rmw %g/%g/%g/%g/%g, %s",
+	                      this->nr_thread, (double) this->op_prop.op[READ], (double) this->op_prop.op[UPDATE],
+	                      (double) this->op_prop.op[INSERT], (double) this->op_prop.op[SCAN],
+	                      (double) this->op_prop.op[READ_MODIFY_WRITE], this->request_distribution.c_str());
+	if (this->request_distribution != "uniform")
+		length += snprintf(buffer + length, sizeof(buffer) - (size_t) length, " %g", this->zipfian_constant);
+	snprintf(buffer + length, sizeof(buffer) - (size_t) length, ", next_op_interval_ns %ld", this->next_op_interval_ns);
+	return buffer;
+}
+
+bool SweepConfig::enabled() const {
+	return !this->nr_thread_list.empty() || !this->operation_proportion_list.empty()
+	       || !this->request_distribution_list.empty() || !this->zipfian_constant_list.empty()
+	       || !this->next_op_interval_ns_list.empty();
+}
+
+std::vector<SweepPoint> SweepConfig::expand(const SweepPoint &base_point) const {
+	/* an empty dimension sweeps over the base value alone */
+	std::vector<int> nr_thread_list = this->nr_thread_list;
+	std::vector<struct OpProportion> operation_proportion_list = this->operation_proportion_list;
+	std::vector<std::string> request_distribution_list = this->request_distribution_list;
+	std::vector<double> zipfian_constant_list = this->zipfian_constant_list;
+	std::vector<long> next_op_interval_ns_list = this->next_op_interval_ns_list;
+	if (nr_thread_list.empty())
+		nr_thread_list.push_back(base_point.nr_thread);
+	if (operation_proportion_list.empty())
+		operation_proportion_list.push_back(base_point.op_prop);
+	if (request_distribution_list.empty())
+		request_distribution_list.push_back(base_point.request_distribution);
+	if (zipfian_constant_list.empty())
+		zipfian_constant_list.push_back(base_point.zipfian_constant);
+	if (next_op_interval_ns_list.empty())
+		next_op_interval_ns_list.push_back(base_point.next_op_interval_ns);
+
+	std::vector<SweepPoint> point_arr;
+	for (const std::string &request_distribution : request_distribution_list) {
+		/* the skew does not change a uniform workload */
+		size_t nr_zipfian_constant = request_distribution == "uniform" ? 1 : zipfian_constant_list.size();
+		for (size_t i = 0; i < nr_zipfian_constant; ++i) {
+			for (const struct OpProportion &op_prop : operation_proportion_list) {
+				for (long next_op_interval_ns : next_op_interval_ns_list) {
+					for (int nr_thread : nr_thread_list) {
+						SweepPoint point;
+						point.nr_thread = nr_thread;
+						point.op_prop = op_prop;
+						point.request_distribution = request_distribution;
+						point.zipfian_constant = zipfian_constant_list[i];
+						point.next_op_interval_ns = next_op_interval_ns;
+						point_arr.push_back(point);
+					}
+				}
+			}
+		}
+	}
+	return point_arr;
+}
+
+SweepConfig SweepConfig::parse_yaml(YAML::Node &root) {
+	SweepConfig config;
+	YAML::Node sweep = root["sweep"];
+	if (!sweep)
+		return config;
+
+	if (sweep["nr_thread"])
+		config.nr_thread_list = sweep["nr_thread"].as<std::vector<int>>();
+	if (sweep["operation_proportion"]) {
+		for (YAML::Node operation_proportion : sweep["operation_proportion"]) {
+			/* missing op types get no share */
+			struct OpProportion op_prop;
+			op_prop.op[READ] = operation_proportion["read"] ? operation_proportion["read"].as<float>() : 0;
+			op_prop.op[UPDATE] = operation_proportion["update"] ? operation_proportion["update"].as<float>() : 0;
+			op_prop.op[INSERT] = operation_proportion["insert"] ? operation_proportion["insert"].as<float>() : 0;
+			op_prop.op[SCAN] = operation_proportion["scan"] ? operation_proportion["scan"].as<float>() : 0;
+			op_prop.op[READ_MODIFY_WRITE] = operation_proportion["read_modify_write"]
+			                                ? operation_proportion["read_modify_write"].as<float>() : 0;
+			config.operation_proportion_list.push_back(op_prop);
+		}
+	}
+	if (sweep["request_distribution"])
+		config.request_distribution_list = sweep["request_distribution"].as<std::vector<std::string>>();
+	if (sweep["zipfian_constant"])
+		config.zipfian_constant_list = sweep["zipfian_constant"].as<std::vector<double>>();
+	if (sweep["next_op_interval_ns"])
+		config.next_op_interval_ns_list = sweep["next_op_interval_ns"].as<std::vector<long>>();
+	if (sweep["warmup_each_point"])
+		config.warmup_each_point = sweep["warmup_each_point"].as<bool>();
+	if (sweep["table_file"])
+		config.table_file = sweep["table_file"].as<std::string>();
+
+	for (int nr_thread : config.nr_thread_list) {
+		if (nr_thread < 1) {
+			fprintf(stderr, "SweepConfig: nr_thread values must be at least 1\n");
+			throw std::invalid_argument("invalid sweep nr_thread");
+		}
+	}
+	/* a typo would otherwise only fail once the points before it have run */
+	for (const std::string &request_distribution : config.request_distribution_list) {
+		if (request_distribution != "uniform" && request_distribution != "zipfian" && request_distribution != "latest") {
+			fprintf(stderr, "SweepConfig: unknown request_distribution %s, use uniform, zipfian or latest\n",
+			        request_distribution.c_str());
+			throw std::invalid_argument("invalid sweep request_distribution");
+		}
+	}
+	for (long next_op_interval_ns : config.next_op_interval_ns_list) {
+		if (next_op_interval_ns < 0) {
+			fprintf(stderr, "SweepConfig: next_op_interval_ns values must not be negative\n");
+			throw std::invalid_argument("invalid sweep next_op_interval_ns");
+		}
+	}
+	for (const struct OpProportion &op_prop : config.operation_proportion_list) {
+		float total = 0;
+		for (int i = 0; i < NR_OP_TYPE; ++i)
+			total += op_prop.op[i];
+		if (total <= 0) {
+			fprintf(stderr, "SweepConfig: every operation_proportion needs a positive share\n");
+			throw std::invalid_argument("invalid sweep operation_proportion");
+		}
+	}
+	return config;
+}
+
+void report_sweep(const char *task, const SweepConfig &config, const std::vector<SweepPoint> &point_arr,
+                  const std::vector<std::vector<PhaseResult>> &result_arr) {
+	FILE *table_file = nullptr;
+	if (!config.table_file.empty()) {
+		table_file = fopen(config.table_file.c_str(), "a");
+		if (table_file == nullptr)
+			fprintf(stderr, "report_sweep: failed to open table file %s\n", config.table_file.c_str());
+		else if (ftell(table_file) == 0)
+			fprintf(table_file, "Task,Point,Threads,Read,Update,Insert,Scan,Read Modify Write,Distribution,Zipfian Constant,"
+			        "Next Op Interval (ns),Phases,Throughput (ops/sec),Throughput 95%% CI (ops/sec),P50 (ns),P99 (ns),"
+			        "P99.9 (ns),Response P99 (ns)\n");
+	}
+
+	printf("%s sweep: %zu points\n", task, point_arr.size());
+	for (size_t i = 0; i < point_arr.size() && i < result_arr.size(); ++i) {
+		const SweepPoint &point = point_arr[i];
+		if (result_arr[i].empty()) {
+			printf("%s sweep (point %zu): %s, no result\n", task, i, point.describe().c_str());
+			continue;
+		}
+		/* throughput over the phases, latency over all their ops */
+		std::vector<double> throughput_arr;
+		LatencyHistogram latency_hist(result_arr[i][0].latency_hist.empty() ? LatencyHistogram::default_precision_bits
+		                              : result_arr[i][0].latency_hist[0].precision_bits);
+		LatencyHistogram response_hist(latency_hist.precision_bits);
+		for (const PhaseResult &result : result_arr[i]) {
+			throughput_arr.push_back(result.get_total_throughput());
+			for (const LatencyHistogram &hist : result.latency_hist)
+				latency_hist.merge(hist);
+			for (const LatencyHistogram &hist : result.response_hist)
+				response_hist.merge(hist);
+		}
+		SampleStats throughput(throughput_arr);
+		printf("%s sweep (point %zu): %s, phases %zu, total throughput %.2lf ops/sec (95%% CI +-%.2lf), "
+		       "p50/p99/p99.9 latency %.0lf/%.0lf/%.0lf ns", task, i, point.describe().c_str(), result_arr[i].size(),
+		       throughput.mean, throughput.ci95, latency_hist.get_percentile(0.5), latency_hist.get_percentile(0.99),
+		       latency_hist.get_percentile(0.999));
+		if (response_hist.get_count() > 0)
+			printf(", response p99 latency %.0lf ns", response_hist.get_percentile(0.99));
+		printf("\n");
+		if (table_file != nullptr) {
+			fprintf(table_file, "%s,%zu,%d,%g,%g,%g,%g,%g,%s,", task, i, point.nr_thread, (double) point.op_prop.op[READ],
+			        (double) point.op_prop.op[UPDATE], (double) point.op_prop.op[INSERT], (double) point.op_prop.op[SCAN],
+			        (double) point.op_prop.op[READ_MODIFY_WRITE], point.request_distribution.c_str());
+			/* the constant means nothing to a uniform point */
+			if (point.request_distribution != "uniform")
+				fprintf(table_file, "%g", point.zipfian_constant);
+			fprintf(table_file, ",%ld,%zu,%.2f,%.2f,%.0f,%.0f,%.0f,", point.next_op_interval_ns, result_arr[i].size(),
+			        throughput.mean, throughput.ci95, latency_hist.get_percentile(0.5), latency_hist.get_percentile(0.99),
+			        latency_hist.get_percentile(0.999));
+			if (response_hist.get_count() > 0)
+				fprintf(table_file, "%.0f", response_hist.get_percentile(0.99));
+			fprintf(table_file, "\n");
+		}
+	}
+	if (table_file != nullptr)
+		fclose(table_file);
+}
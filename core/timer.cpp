@@ -0,0 +1,56 @@
+#include <cstdio>
+#include <thread>
+#include "timer.h"
+#if defined(__x86_64__) || defined(__i386__)
+#include <cpuid.h>
+#endif
+
+bool Timer::tsc_enabled = false;
+double Timer::ns_per_tick = 0;
+uint64_t Timer::base_tick = 0;
+long Timer::base_ns = 0;
+
+bool Timer::has_invariant_tsc() {
+#if defined(__x86_64__) || defined(__i386__)
+	unsigned int eax, ebx, ecx, edx;
+	if (!__get_cpuid(0x80000000, &eax, &ebx, &ecx, &edx) || eax < 0x80000007)
+		return false;
+	__get_cpuid(0x80000007, &eax, &ebx, &ecx, &edx);
+	/* CPUID.80000007H:EDX[8], the TSC ticks at a constant rate across P/C-states */
+	return (edx & (1u << 8)) != 0;
+#else
+	return false;
+#endif
+}
+
+void Timer::init(bool use_tsc) {
+	if (!use_tsc) {
+		tsc_enabled = false;
+		return;
+	}
+	if (!has_invariant_tsc()) {
+		fprintf(stderr, "Timer: TSC is not invariant, falling back to steady_clock\n");
+		tsc_enabled = false;
+		return;
+	}
+#if defined(__x86_64__) || defined(__i386__)
+	if (ns_per_tick == 0) {
+		unsigned int aux;
+		long start_ns = steady_now_ns();
+		uint64_t start_tick = __rdtscp(&aux);
+		std::this_thread::sleep_for(std::chrono::milliseconds(100));
+		long end_ns = steady_now_ns();
+		uint64_t end_tick = __rdtscp(&aux);
+		if (end_tick <= start_tick) {
+			fprintf(stderr, "Timer: TSC calibration failed, falling back to steady_clock\n");
+			tsc_enabled = false;
+			return;
+		}
+		ns_per_tick = (double) (end_ns - start_ns) / (double) (end_tick - start_tick);
+		base_tick = end_tick;
+		base_ns = end_ns;
+		printf("Timer: using invariant TSC at %.3f GHz\n", 1 / ns_per_tick);
+	}
+	tsc_enabled = true;
+#endif
+}
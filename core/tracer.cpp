@@ -0,0 +1,101 @@
+#include <cstdio>
+#include "tracer.h"
+#include "timer.h"
+#include "workload.h"
+
+const char *trace_span_name[] = {
+	"next_op", "pacing", "do_operation", "record_op"
+};
+
+/* marker tid, worker tids are client ids */
+static const int trace_monitor_tid = -1;
+
+TraceRing::TraceRing(int client_id, long capacity)
+	: client_id(client_id), event_arr((unsigned long) capacity), nr_event(0) {}
+
+Tracer::Tracer(long ring_capacity) : ring_capacity(ring_capacity) {
+	this->base_timestamp = Timer::now_ns();
+}
+
+Tracer::~Tracer() {
+	for (TraceRing *ring : this->ring_list) {
+		delete ring;
+	}
+}
+
+TraceRing *Tracer::add_client(int client_id) {
+	TraceRing *ring = new TraceRing(client_id, this->ring_capacity);
+	this->ring_list.push_back(ring);
+	return ring;
+}
+
+void Tracer::add_marker(long timestamp, const std::string &name, const std::string &detail) {
+	std::lock_guard<std::mutex> guard(this->marker_lock);
+	this->marker_arr.push_back({timestamp, name, detail});
+}
+
+static void write_json_string(FILE *file, const std::string &str) {
+	fputc('"', file);
+	for (char c : str) {
+		if (c == '"' || c == '\\')
+			fprintf(file, "\\%c", c);
+		else if ((unsigned char) c < 0x20)
+			fprintf(file, "\\u%04x", (unsigned int) c);
+		else
+			fputc(c, file);
+	}
+	fputc('"', file);
+}
+
+bool Tracer::write_json(const char *path, const char *task) {
+	FILE *file = fopen(path, "w");
+	if (file == nullptr) {
+		fprintf(stderr, "Tracer: failed to open %s\n", path);
+		return false;
+	}
+	fprintf(file, "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n");
+	fprintf(file, "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"args\":{\"name\":");
+	write_json_string(file, task);
+	fprintf(file, "}},\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"args\":{\"name\":\"monitor\"}}",
+	        trace_monitor_tid);
+
+	long nr_event = 0, nr_dropped = 0;
+	for (TraceRing *ring : this->ring_list) {
+		fprintf(file, ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"args\":{\"name\":\"worker %d\"}}",
+		        ring->client_id, ring->client_id);
+		uint64_t capacity = ring->event_arr.size();
+		uint64_t first = ring->nr_event > capacity ? ring->nr_event - capacity : 0;
+		nr_dropped += (long) first;
+		for (uint64_t i = first; i < ring->nr_event; ++i) {
+			const TraceEvent &event = ring->event_arr[i % capacity];
+			fprintf(file, ",\n{\"name\":\"%s\",\"cat\":\"worker\",\"ph\":\"X\",\"pid\":1,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f",
+			        trace_span_name[event.span], ring->client_id, (double) (event.begin - this->base_timestamp) / 1e3,
+			        (double) (event.end - event.begin) / 1e3);
+			if (event.op_type >= 0 && event.op_type < NR_OP_TYPE)
+				fprintf(file, ",\"args\":{\"op\":\"%s\"}", operation_type_name[event.op_type]);
+			fprintf(file, "}");
+			++nr_event;
+		}
+	}
+
+	std::lock_guard<std::mutex> guard(this->marker_lock);
+	for (const TraceMarker &marker : this->marker_arr) {
+		fprintf(file, ",\n{\"name\":");
+		write_json_string(file, marker.name);
+		fprintf(file, ",\"cat\":\"monitor\",\"ph\":\"i\",\"s\":\"g\",\"pid\":1,\"tid\":%d,\"ts\":%.3f", trace_monitor_tid,
+		        (double) (marker.timestamp - this->base_timestamp) / 1e3);
+		if (!marker.detail.empty()) {
+			fprintf(file, ",\"args\":{\"detail\":");
+			write_json_string(file, marker.detail);
+			fprintf(file, "}");
+		}
+		fprintf(file, "}");
+	}
+	fprintf(file, "\n]}\n");
+	fclose(file);
+	printf("%s: wrote %ld trace events and %zu markers to %s", task, nr_event, this->marker_arr.size(), path);
+	if (nr_dropped > 0)
+		printf(", %ld older events were overwritten", nr_dropped);
+	printf("\n");
+	return true;
+}
@@ -1,14 +1,21 @@
 #include <chrono>
+#include <functional>
 #include <thread>
 #include "worker.h"
 
-void worker_thread_fn(Client *client, Workload *workload, OpMeasurement *measurement, long next_op_interval_ns) {
+/* longest single sleep of a paced worker, bounds how late it notices the end of the phase */
+static const long max_pacing_sleep_ns = 100000000;
+
+void worker_thread_fn(Client *client, Workload *workload, OpMeasurement *measurement, ArrivalProcess *arrival) {
 	Operation op;
 	op.key_buffer = new char[workload->key_size];
 	op.value_buffer = new char[workload->value_size];
 	op.value_buffer_size = workload->value_size;
-	std::chrono::steady_clock::time_point start_time, finish_time;
-	std::chrono::steady_clock::time_point next_op_time = std::chrono::steady_clock::now();
+	op.scan_length = 1;
+	op.popularity_rank = -1;
+	/* Timer ns, each boundary is read once and shared by pacing, latency and the latency log */
+	long start_time, finish_time;
+	long next_op_time = Timer::now_ns();
 
 	// If the workload has scans:
 	// - Check the scan_worker_count field in the workload object.
@@ -16,50 +23,315 @@ void worker_thread_fn(Client *client, Workload *workload, OpMeasurement *measure
 	// - If it's greater than zero, check the worker's id number. If it's less
 	//   than the scan_worker_count, the worker should perform only scans.
 
-	measurement->start_measure();
+	measurement->start_measure(client->id);
 	while (workload->has_next_op()) {
 		// Finish earlier if runtime expires
 		if (measurement->finished) {
 			break;
 		}
+		/* sampled ops also time next_op, the pacing sleep and the bookkeeping */
+		bool traced = measurement->should_trace(client->id);
+		long trace_time = traced ? Timer::now_ns() : 0;
 		workload->next_op(&op);
 
-		if (std::chrono::steady_clock::now() < next_op_time) {
-			std::this_thread::sleep_until(next_op_time);
+		start_time = Timer::now_ns();
+		if (traced)
+			measurement->trace_span(TRACE_NEXT_OP, op.type, trace_time, start_time, client->id);
+		/* a rate schedule hands out start times from one bucket shared by all workers */
+		if (measurement->rate_pacer != nullptr)
+			next_op_time = measurement->rate_pacer->acquire(start_time, arrival);
+		if (start_time < next_op_time) {
+			/* sleep in slices, so a slow schedule does not outlive the phase */
+			trace_time = start_time;
+			while (start_time < next_op_time && !measurement->finished) {
+				std::this_thread::sleep_for(std::chrono::nanoseconds(std::min(next_op_time - start_time, max_pacing_sleep_ns)));
+				start_time = Timer::now_ns();
+			}
+			if (traced)
+				measurement->trace_span(TRACE_PACING, op.type, trace_time, start_time, client->id);
+			if (start_time < next_op_time)
+				break;
+		}
+		/* the counter read is a syscall, start the clock after it so latencies leave it out */
+		if (measurement->config.perf_counters_per_op_type) {
+			measurement->perf_op_begin(client->id);
+			start_time = Timer::now_ns();
 		}
-		start_time = std::chrono::steady_clock::now();
 		client->do_operation(&op);
-		finish_time = std::chrono::steady_clock::now();
-		long latency = std::chrono::duration_cast<std::chrono::nanoseconds>(finish_time - start_time).count();
-		measurement->record_op(op.type, (double) latency, client->id);
-		measurement->record_progress(1);
-		next_op_time += std::chrono::nanoseconds(next_op_interval_ns);
+		finish_time = Timer::now_ns();
+		if (measurement->config.perf_counters_per_op_type)
+			measurement->perf_op_end(op.type, client->id);
+		if (traced)
+			measurement->trace_span(TRACE_DO_OPERATION, op.type, start_time, finish_time, client->id);
+		long latency = finish_time - start_time;
+		measurement->record_op(op.type, (double) latency, client->id, finish_time, op.popularity_rank);
+		if (measurement->is_slow_op(latency, client->id))
+			measurement->record_slow_op(&op, start_time, latency, client->id);
+		if (measurement->record_response_time) {
+			/* charge queueing behind a stalled op to the ops that were due meanwhile */
+			long response_time = finish_time - next_op_time;
+			long schedule_lag = start_time - next_op_time;
+			measurement->record_response(op.type, (double) response_time, (double) schedule_lag, client->id);
+		}
+		measurement->record_progress(1, client->id);
+		if (op.type == SCAN)
+			measurement->record_scan(op.scan_length, client->id);
+		if (traced)
+			measurement->trace_span(TRACE_RECORD_OP, op.type, finish_time, Timer::now_ns(), client->id);
+		if (measurement->rate_pacer == nullptr)
+			next_op_time += arrival->next_gap_ns();
 	}
-	measurement->finish_measure();
+	measurement->finish_measure(client->id);
 	client->reset();
 	delete[] op.key_buffer;
 	delete[] op.value_buffer;
 }
 
-void monitor_thread_fn(const char *task, OpMeasurement *measurement, long runtime_seconds) {
+/* appends backend events to the event file, elapsed seconds are relative to the monitor's start */
+static void write_events(FILE *event_file, const char *task, long epoch, long start_ns,
+                         const std::vector<BackendEvent> &event_arr) {
+	if (event_file == nullptr)
+		return;
+	for (const BackendEvent &event : event_arr) {
+		fprintf(event_file, "%s,%ld,%.3f,%s,\"%s\"\n", task, epoch, (double) (event.timestamp - start_ns) / 1e9,
+		        event.name.c_str(), event.detail.c_str());
+	}
+}
+
+/* change of a cumulative counter since prev, a counter that went backwards was reset, count from zero */
+static double counter_delta(double value, double prev) {
+	return value >= prev ? value - prev : value;
+}
+
+/* appends one sample of engine statistics, counters as deltas since the previous sample */
+static void write_backend_stats(FILE *backend_stats_file, const char *task, long epoch, double elapsed, double interval,
+                                const std::vector<BackendStat> &stat_arr, std::map<std::string, double> *prev_counter_map) {
+	for (const BackendStat &stat : stat_arr) {
+		if (!stat.is_counter) {
+			fprintf(backend_stats_file, "%s,%ld,%.3f,%.3f,\"%s\",gauge,%.15g,\n", task, epoch, elapsed, interval,
+			        stat.name.c_str(), stat.value);
+			continue;
+		}
+		auto prev_it = prev_counter_map->find(stat.name);
+		if (prev_it != prev_counter_map->end() && interval > 0) {
+			double delta = counter_delta(stat.value, prev_it->second);
+			fprintf(backend_stats_file, "%s,%ld,%.3f,%.3f,\"%s\",counter,%.0f,%.2f\n", task, epoch, elapsed, interval,
+			        stat.name.c_str(), delta, delta / interval);
+		}
+		(*prev_counter_map)[stat.name] = stat.value;
+	}
+	fflush(backend_stats_file);
+}
+
+/* "name value" for gauges and "name +delta" for counters since the previous epoch, for the epoch's background column */
+static std::string format_stat_annotation(const std::vector<BackendStat> &stat_arr, std::map<std::string, double> *prev_counter_map) {
+	std::string annotation;
+	char buffer[256];
+	for (const BackendStat &stat : stat_arr) {
+		if (!stat.is_counter) {
+			snprintf(buffer, sizeof(buffer), "%s %.15g", stat.name.c_str(), stat.value);
+		} else {
+			auto prev_it = prev_counter_map->find(stat.name);
+			if (prev_it == prev_counter_map->end()) {
+				(*prev_counter_map)[stat.name] = stat.value;
+				continue;
+			}
+			snprintf(buffer, sizeof(buffer), "%s +%.0f", stat.name.c_str(), counter_delta(stat.value, prev_it->second));
+			prev_it->second = stat.value;
+		}
+		annotation += (annotation.empty() ? "" : ", ") + std::string(buffer);
+	}
+	return annotation;
+}
+
+void monitor_thread_fn(const char *task, ClientFactory *factory, OpMeasurement *measurement, long runtime_seconds) {
 	double rt_throughput[NR_OP_TYPE];
+	std::vector<LatencyHistogram> rt_latency(NR_OP_TYPE, LatencyHistogram(measurement->config.histogram_precision_bits));
 	double progress;
 	long epoch = 0;
 	std::chrono::steady_clock::time_point start_time, curr_time;
 	start_time = std::chrono::steady_clock::now();
+	/* Timer shares the steady_clock epoch */
+	long start_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(start_time.time_since_epoch()).count();
+
+	FILE *timeline_file = nullptr;
+	if (!measurement->config.timeline_file.empty()) {
+		/* phases of one run append to the same file */
+		timeline_file = fopen(measurement->config.timeline_file.c_str(), "a");
+		if (timeline_file == nullptr) {
+			fprintf(stderr, "monitor: failed to open timeline file %s\n", measurement->config.timeline_file.c_str());
+			throw std::invalid_argument("failed to open timeline file");
+		}
+		if (ftell(timeline_file) == 0)
+			fprintf(timeline_file, "Task,Epoch,Elapsed (s),Operation,Throughput (ops/sec),Count,P50 (ns),P99 (ns),P99.9 (ns),Max (ns),"
+			        "Process Read (MB/s),Process Write (MB/s),Device Read (MB/s),Device Read IOPS,Device Write (MB/s),Device Write IOPS,Background,"
+			        "Target Throughput (ops/sec)\n");
+	}
+	FILE *event_file = nullptr;
+	if (!measurement->config.event_file.empty()) {
+		event_file = fopen(measurement->config.event_file.c_str(), "a");
+		if (event_file == nullptr) {
+			fprintf(stderr, "monitor: failed to open event file %s\n", measurement->config.event_file.c_str());
+			throw std::invalid_argument("failed to open event file");
+		}
+		if (ftell(event_file) == 0)
+			fprintf(event_file, "Task,Epoch,Elapsed (s),Event,Detail\n");
+	}
+	std::vector<BackendEvent> event_arr;
+	FILE *backend_stats_file = nullptr;
+	if (!measurement->config.backend_stats_file.empty()) {
+		backend_stats_file = fopen(measurement->config.backend_stats_file.c_str(), "a");
+		if (backend_stats_file == nullptr) {
+			fprintf(stderr, "monitor: failed to open backend stats file %s\n", measurement->config.backend_stats_file.c_str());
+			throw std::invalid_argument("failed to open backend stats file");
+		}
+		if (ftell(backend_stats_file) == 0)
+			fprintf(backend_stats_file, "Task,Epoch,Elapsed (s),Interval (s),Statistic,Type,Value,Rate (/s)\n");
+	}
+	/* the first sample of a phase is only the baseline for counters */
+	std::vector<BackendStat> stat_arr;
+	std::map<std::string, double> prev_counter_map;
+	double prev_stats_elapsed = 0;
+	/* baseline for the phase's backend statistics in the final report */
+	std::vector<BackendStat> phase_start_stat_arr;
+	factory->sample_stats(&phase_start_stat_arr);
+	/* counters of the epoch annotation, baselined at the phase start so the first epoch has deltas too */
+	bool annotate_stats = factory->stats_in_epoch_annotation();
+	std::map<std::string, double> prev_epoch_counter_map;
+	for (const BackendStat &stat : phase_start_stat_arr) {
+		if (stat.is_counter)
+			prev_epoch_counter_map[stat.name] = stat.value;
+	}
+	SteadyStateDetector steady_state(measurement->config.steady_state_window, measurement->config.steady_state_stable_epochs,
+	                                 measurement->config.steady_state_max_cv);
+	double steady_state_seconds = -1;
+	ProcessIoUsage prev_process_io = ProcessIoUsage::current();
+	DeviceIoUsage prev_device_io = measurement->get_device_io_now();
+	double prev_elapsed = 0;
+	long prev_epoch_timestamp = start_ns;
 
 	for (;!measurement->finished
 	     ;std::this_thread::sleep_for(std::chrono::seconds(1)), ++epoch) {
 		measurement->get_rt_throughput(rt_throughput);
+		measurement->get_rt_latency(rt_latency);
 		progress = measurement->get_progress_percent();
+		curr_time = std::chrono::steady_clock::now();
 		printf("%s (epoch %ld, progress %.2f%%): ", task, epoch, 100 * progress);
 		double total_throughput = 0;
 		for (int i = 0; i < NR_OP_TYPE; ++i) {
 			printf("%s throughput %.2lf ops/sec, ", operation_type_name[i], rt_throughput[i]);
 			total_throughput += rt_throughput[i];
 		}
-		printf("total throughput %.2lf ops/sec\n", total_throughput);
-		curr_time = std::chrono::steady_clock::now();
+		printf("total throughput %.2lf ops/sec", total_throughput);
+		/* what the open-loop schedule asked for over the same epoch */
+		long epoch_timestamp = Timer::now_ns();
+		double target_throughput = measurement->get_target_throughput(prev_epoch_timestamp, epoch_timestamp);
+		prev_epoch_timestamp = epoch_timestamp;
+		if (target_throughput > 0)
+			printf(", target throughput %.2lf ops/sec", target_throughput);
+		long rss_kb = get_rss_kb();
+		measurement->max_rss_kb = std::max(measurement->max_rss_kb, rss_kb);
+		printf(", rss %.2lf MB", (double) rss_kb / 1024);
+		std::map<std::string, PageCacheUsage> page_cache_usage_map;
+		/* the sampler runs at idle priority, so it must not take the db mutex itself */
+		if (measurement->page_cache_sampler != nullptr)
+			measurement->page_cache_sampler->update_file_groups();
+		if (measurement->page_cache_sampler != nullptr
+		    && measurement->page_cache_sampler->get_last_usage(&page_cache_usage_map)) {
+			const PageCacheUsage &usage = page_cache_usage_map["total"];
+			printf(", page cache %.2lf/%.2lf MB (%.2lf%%)", (double) usage.resident_bytes / 1e6, (double) usage.total_bytes / 1e6,
+			       usage.total_bytes > 0 ? 100 * (double) usage.resident_bytes / (double) usage.total_bytes : 0);
+		}
+		double elapsed = std::chrono::duration<double>(curr_time - start_time).count();
+
+		/* i/o rates since the previous epoch */
+		ProcessIoUsage cur_process_io = ProcessIoUsage::current();
+		DeviceIoUsage cur_device_io = measurement->get_device_io_now();
+		ProcessIoUsage epoch_process_io = cur_process_io - prev_process_io;
+		DeviceIoUsage epoch_device_io = cur_device_io - prev_device_io;
+		double epoch_seconds = elapsed - prev_elapsed > 0 ? elapsed - prev_elapsed : 1;
+		double process_read_mbps = (double) epoch_process_io.read_bytes / 1e6 / epoch_seconds;
+		double process_write_mbps = (double) epoch_process_io.write_bytes / 1e6 / epoch_seconds;
+		double device_read_mbps = (double) epoch_device_io.read_bytes / 1e6 / epoch_seconds;
+		double device_read_iops = (double) epoch_device_io.nr_read / epoch_seconds;
+		double device_write_mbps = (double) epoch_device_io.write_bytes / 1e6 / epoch_seconds;
+		double device_write_iops = (double) epoch_device_io.nr_write / epoch_seconds;
+		prev_process_io = cur_process_io;
+		prev_device_io = cur_device_io;
+		prev_elapsed = elapsed;
+		printf(", process read/write %.2lf/%.2lf MB/s", process_read_mbps, process_write_mbps);
+		if (measurement->has_io_device)
+			printf(", %s read %.2lf MB/s %.0lf IOPS write %.2lf MB/s %.0lf IOPS", measurement->io_device_name.c_str(),
+			       device_read_mbps, device_read_iops, device_write_mbps, device_write_iops);
+
+		/* background work of the backend, so throughput dips can be matched with flushes, compactions and stalls */
+		event_arr.clear();
+		factory->drain_events(&event_arr);
+		write_events(event_file, task, epoch, start_ns, event_arr);
+		std::map<std::string, int> event_count_map;
+		for (const BackendEvent &event : event_arr) {
+			++event_count_map[event.name];
+			if (measurement->tracer != nullptr)
+				measurement->tracer->add_marker(event.timestamp, event.name, event.detail);
+		}
+		/* one sample per epoch, shared by the annotation and the backend stats file */
+		bool write_stats = backend_stats_file != nullptr && epoch % measurement->config.backend_stats_interval_seconds == 0;
+		if (write_stats || annotate_stats) {
+			stat_arr.clear();
+			factory->sample_stats(&stat_arr);
+		}
+		std::string background = factory->get_epoch_annotation();
+		if (annotate_stats) {
+			std::string stat_annotation = format_stat_annotation(stat_arr, &prev_epoch_counter_map);
+			if (!background.empty() && !stat_annotation.empty())
+				background += ", ";
+			background += stat_annotation;
+		}
+		for (auto &event_count : event_count_map) {
+			if (!background.empty())
+				background += ", ";
+			background += std::to_string(event_count.second) + " " + event_count.first;
+		}
+		if (!background.empty())
+			printf(", background: %s", background.c_str());
+		if (measurement->tracer != nullptr) {
+			char detail[128];
+			snprintf(detail, sizeof(detail), "total throughput %.2lf ops/sec", total_throughput);
+			measurement->tracer->add_marker(Timer::now_ns(), "epoch " + std::to_string(epoch), detail);
+		}
+		if (write_stats) {
+			write_backend_stats(backend_stats_file, task, epoch, elapsed, elapsed - prev_stats_elapsed, stat_arr,
+			                    &prev_counter_map);
+			prev_stats_elapsed = elapsed;
+		}
+
+		for (size_t i = 0; i < NR_OP_TYPE; ++i) {
+			const LatencyHistogram &hist = rt_latency[i];
+			if (hist.get_count() > 0)
+				printf(", %s p50/p99/p99.9/max latency %.0lf/%.0lf/%.0lf/%ld ns", operation_type_name[i],
+				       hist.get_percentile(0.5), hist.get_percentile(0.99), hist.get_percentile(0.999), hist.get_max());
+			/* every op type gets a row, zeros included, so an epoch that stalled still shows up */
+			if (timeline_file != nullptr) {
+				fprintf(timeline_file, "%s,%ld,%.3f,%s,%.2f,%ld,%.0f,%.0f,%.0f,%ld,%.2f,%.2f,%.2f,%.0f,%.2f,%.0f,\"%s\",%.2f\n", task, epoch, elapsed,
+				        operation_type_name[i], rt_throughput[i], hist.get_count(),
+				        hist.get_percentile(0.5), hist.get_percentile(0.99), hist.get_percentile(0.999), hist.get_max(),
+				        process_read_mbps, process_write_mbps, device_read_mbps, device_read_iops,
+				        device_write_mbps, device_write_iops, background.c_str(), target_throughput);
+			}
+		}
+		printf("\n");
+		if (measurement->config.stop_at_steady_state && total_throughput > 0) {
+			/* p99 over all op types, epochs without ops say nothing about stability */
+			LatencyHistogram epoch_hist(measurement->config.histogram_precision_bits);
+			for (size_t i = 0; i < NR_OP_TYPE; ++i)
+				epoch_hist.merge(rt_latency[i]);
+			if (steady_state.add_epoch(total_throughput, epoch_hist.get_percentile(0.99))) {
+				steady_state_seconds = elapsed;
+				printf("%s: steady state after %.1lf s (epoch %ld), throughput cv %.4lf, p99 cv %.4lf\n", task, elapsed, epoch,
+				       steady_state.throughput_cv, steady_state.latency_cv);
+				measurement->finished = true;
+			}
+		}
 		// std::cerr << "runtime seconds: " << runtime_seconds << std::endl;
 		// std::cerr << "start time: " << start_time.time_since_epoch().count() << std::endl;
 		// std::cerr << "curr time: " << curr_time.time_since_epoch().count() << std::endl;
@@ -70,7 +342,18 @@ void monitor_thread_fn(const char *task, OpMeasurement *measurement, long runtim
 		}
 		std::cout << std::flush;
 	}
-	printf("%s: calculating overall performance metrics... (might take a while)\n", task);
+	if (timeline_file != nullptr)
+		fclose(timeline_file);
+	if (backend_stats_file != nullptr)
+		fclose(backend_stats_file);
+	if (event_file != nullptr) {
+		/* events of the last, partial epoch */
+		event_arr.clear();
+		factory->drain_events(&event_arr);
+		write_events(event_file, task, epoch, start_ns, event_arr);
+		fclose(event_file);
+	}
+	printf("%s: calculating overall performance metrics...\n", task);
 	std::cerr << std::flush;
 	measurement->final_result_lock.lock();
 
@@ -83,6 +366,121 @@ void monitor_thread_fn(const char *task, OpMeasurement *measurement, long runtim
 	}
 	printf("total throughput %.2lf ops/sec\n", total_throughput);
 
+	if (measurement->config.stop_at_steady_state) {
+		if (steady_state_seconds >= 0)
+			printf("%s overall: warm-up reached steady state after %.1lf s\n", task, steady_state_seconds);
+		else
+			printf("%s overall: warm-up ended before steady state (last throughput cv %.4lf, p99 cv %.4lf)\n", task,
+			       steady_state.throughput_cv, steady_state.latency_cv);
+	}
+
+	/* print cpu time, context switches and page faults of the workers */
+	ThreadUsage usage = measurement->get_thread_usage();
+	long nr_op = measurement->get_progress();
+	double op_divisor = nr_op > 0 ? (double) nr_op : 1;
+	printf("%s overall (cpu): user %.3lf s, sys %.3lf s, cpu %.2lf us/op, voluntary switches %ld (%.4lf/op), "
+	       "involuntary switches %ld (%.4lf/op), major faults %ld (%.4lf/op), minor faults %ld (%.4lf/op), max rss %.2lf MB\n",
+	       task, (double) usage.user_us / 1e6, (double) usage.sys_us / 1e6,
+	       (double) (usage.user_us + usage.sys_us) / op_divisor,
+	       usage.nr_voluntary_switch, (double) usage.nr_voluntary_switch / op_divisor,
+	       usage.nr_involuntary_switch, (double) usage.nr_involuntary_switch / op_divisor,
+	       usage.nr_major_fault, (double) usage.nr_major_fault / op_divisor,
+	       usage.nr_minor_fault, (double) usage.nr_minor_fault / op_divisor,
+	       (double) measurement->max_rss_kb / 1024);
+
+	/* print i/o over the phase, amplification is storage bytes per logical byte */
+	double duration = std::chrono::duration<double>(measurement->end_time - measurement->start_time).count();
+	double duration_divisor = duration > 0 ? duration : 1;
+	/* a SCAN reads every record it asks for, not just one */
+	double logical_read_bytes = (double) ((measurement->get_op_count(READ) + measurement->get_scan_record_count()
+	                                       + measurement->get_op_count(READ_MODIFY_WRITE)) * measurement->record_size);
+	double logical_write_bytes = (double) ((measurement->get_op_count(UPDATE) + measurement->get_op_count(INSERT)
+	                                        + measurement->get_op_count(READ_MODIFY_WRITE)) * measurement->record_size);
+	ProcessIoUsage &process_io = measurement->process_io;
+	printf("%s overall (io): process read %.2lf MB (%.2lf MB/s), process write %.2lf MB (%.2lf MB/s)", task,
+	       (double) process_io.read_bytes / 1e6, (double) process_io.read_bytes / 1e6 / duration_divisor,
+	       (double) process_io.write_bytes / 1e6, (double) process_io.write_bytes / 1e6 / duration_divisor);
+	double storage_read_bytes = (double) process_io.read_bytes;
+	double storage_write_bytes = (double) process_io.write_bytes;
+	if (measurement->has_io_device) {
+		DeviceIoUsage &device_io = measurement->device_io;
+		printf(", %s read %.2lf MB (%.2lf MB/s, %.0lf IOPS), %s write %.2lf MB (%.2lf MB/s, %.0lf IOPS)",
+		       measurement->io_device_name.c_str(), (double) device_io.read_bytes / 1e6,
+		       (double) device_io.read_bytes / 1e6 / duration_divisor, (double) device_io.nr_read / duration_divisor,
+		       measurement->io_device_name.c_str(), (double) device_io.write_bytes / 1e6,
+		       (double) device_io.write_bytes / 1e6 / duration_divisor, (double) device_io.nr_write / duration_divisor);
+		/* the device also sees other processes, but catches writeback the process counters miss */
+		storage_read_bytes = (double) device_io.read_bytes;
+		storage_write_bytes = (double) device_io.write_bytes;
+	}
+	printf(", read amplification %.2lf, write amplification %.2lf\n",
+	       logical_read_bytes > 0 ? storage_read_bytes / logical_read_bytes : 0,
+	       logical_write_bytes > 0 ? storage_write_bytes / logical_write_bytes : 0);
+
+	/* print page-cache residency of the last sample */
+	std::map<std::string, PageCacheUsage> page_cache_usage_map;
+	if (measurement->page_cache_sampler != nullptr
+	    && measurement->page_cache_sampler->get_last_usage(&page_cache_usage_map)) {
+		printf("%s overall (page cache): ", task);
+		const char *separator = "";
+		for (auto &usage_it : page_cache_usage_map) {
+			const PageCacheUsage &usage = usage_it.second;
+			printf("%s%s %.2lf/%.2lf MB (%.2lf%%)", separator, usage_it.first.c_str(), (double) usage.resident_bytes / 1e6,
+			       (double) usage.total_bytes / 1e6,
+			       usage.total_bytes > 0 ? 100 * (double) usage.resident_bytes / (double) usage.total_bytes : 0);
+			separator = ", ";
+		}
+		printf("\n");
+	}
+
+	/* print backend statistics over the phase, counters as deltas and gauges as last sampled */
+	std::vector<BackendStat> phase_end_stat_arr;
+	factory->sample_stats(&phase_end_stat_arr);
+	if (!phase_end_stat_arr.empty()) {
+		std::map<std::string, double> phase_start_map;
+		for (const BackendStat &stat : phase_start_stat_arr)
+			phase_start_map[stat.name] = stat.value;
+		printf("%s overall (backend): ", task);
+		const char *separator = "";
+		for (const BackendStat &stat : phase_end_stat_arr) {
+			if (!stat.is_counter) {
+				printf("%s%s %.15g", separator, stat.name.c_str(), stat.value);
+			} else {
+				auto start_it = phase_start_map.find(stat.name);
+				double delta = start_it == phase_start_map.end() || stat.value < start_it->second
+				               ? stat.value : stat.value - start_it->second;
+				printf("%s%s +%.0lf (%.2lf/s)", separator, stat.name.c_str(), delta, delta / duration_divisor);
+			}
+			separator = ", ";
+		}
+		printf("\n");
+	}
+
+	if (measurement->config.perf_counters) {
+		/* print hardware counters, per-op ratios use every op the workers issued */
+		uint64_t cycles = measurement->get_perf_counter(PERF_CYCLES);
+		printf("%s overall (perf%s): ", task, measurement->config.perf_counters_per_op_type ? ", user space" : "");
+		for (int i = 0; i < NR_PERF_COUNTER; ++i) {
+			uint64_t value = measurement->get_perf_counter((PerfCounterType) i);
+			printf("%s %lu (%.2lf/op), ", perf_counter_name[i], value, nr_op > 0 ? (double) value / (double) nr_op : 0);
+		}
+		printf("IPC %.2lf\n", cycles > 0 ? (double) measurement->get_perf_counter(PERF_INSTRUCTIONS) / (double) cycles : 0);
+		if (measurement->config.perf_counters_per_op_type) {
+			for (int i = 0; i < NR_OP_TYPE; ++i) {
+				long op_count = measurement->get_op_count((OperationType) i);
+				if (op_count == 0)
+					continue;
+				cycles = measurement->get_perf_counter((OperationType) i, PERF_CYCLES);
+				printf("%s overall (perf, %s): ", task, operation_type_name[i]);
+				for (int j = 0; j < NR_PERF_COUNTER; ++j) {
+					uint64_t value = measurement->get_perf_counter((OperationType) i, (PerfCounterType) j);
+					printf("%s/op %.2lf, ", perf_counter_name[j], (double) value / (double) op_count);
+				}
+				printf("IPC %.2lf\n", cycles > 0 ? (double) measurement->get_perf_counter((OperationType) i, PERF_INSTRUCTIONS) / (double) cycles : 0);
+			}
+		}
+	}
+
 	/* print latency */
 	printf("%s overall: ", task);
 	for (int i = 0; i < NR_OP_TYPE; ++i) {
@@ -92,34 +490,213 @@ void monitor_thread_fn(const char *task, OpMeasurement *measurement, long runtim
 			printf(", ");
 	}
 	printf("\n");
+
+	if (!measurement->final_popularity_hist.empty()) {
+		/* print latency per popularity class, ranks count from the hottest key */
+		long nr_popularity_op = 0;
+		for (const LatencyHistogram &hist : measurement->final_popularity_hist)
+			nr_popularity_op += hist.get_count();
+		printf("%s overall (popularity): ", task);
+		for (size_t i = 0; i < measurement->final_popularity_hist.size(); ++i) {
+			const LatencyHistogram &hist = measurement->final_popularity_hist[i];
+			long first_rank = i == 0 ? 0 : measurement->popularity_rank_limit_arr[i - 1];
+			if (i < measurement->popularity_rank_limit_arr.size())
+				printf("top %.4g%% (ranks %ld-%ld)", 100 * measurement->config.popularity_buckets[i], first_rank,
+				       measurement->popularity_rank_limit_arr[i] - 1);
+			else
+				printf("rest (ranks %ld-)", first_rank);
+			printf(" %.2lf%% of ops, average latency %.2lf ns, p50/p99/p99.9 latency %.0lf/%.0lf/%.0lf ns",
+			       nr_popularity_op > 0 ? 100 * (double) hist.get_count() / (double) nr_popularity_op : 0,
+			       hist.get_average(), hist.get_percentile(0.5), hist.get_percentile(0.99), hist.get_percentile(0.999));
+			if (i != measurement->final_popularity_hist.size() - 1)
+				printf(", ");
+		}
+		printf("\n");
+	}
+
+	if (measurement->record_response_time) {
+		/* print response time, measured from the intended start time */
+		printf("%s overall (response time): ", task);
+		for (int i = 0; i < NR_OP_TYPE; ++i) {
+			printf("%s average latency %.2lf ns, ", operation_type_name[i], measurement->get_response_average((OperationType) i));
+			printf("%s p99 latency %.2lf ns", operation_type_name[i], measurement->get_response_percentile((OperationType) i, 0.99f));
+			if (i != NR_OP_TYPE - 1)
+				printf(", ");
+		}
+		printf("\n");
+
+		if (measurement->target_ops_per_sec > 0 || measurement->rate_pacer != nullptr) {
+			/* print how well the open-loop schedule was kept */
+			long end_timestamp = std::chrono::duration_cast<std::chrono::nanoseconds>(
+				measurement->end_time.time_since_epoch()).count();
+			double target_throughput = measurement->get_target_throughput(measurement->start_timestamp, end_timestamp);
+			long nr_late_op = 0, max_lag = 0;
+			double total_lag = 0;
+			for (ClientMeasurement *slot : measurement->client_slot_arr) {
+				if (slot == nullptr)
+					continue;
+				nr_late_op += slot->late_op_count;
+				total_lag += slot->total_schedule_lag;
+				max_lag = std::max(max_lag, slot->max_schedule_lag);
+			}
+			long nr_measured_op = 0;
+			for (int i = 0; i < NR_OP_TYPE; ++i)
+				nr_measured_op += measurement->get_op_count((OperationType) i);
+			printf("%s overall (arrivals): ", task);
+			if (measurement->rate_pacer != nullptr)
+				printf("%s schedule, ", rate_schedule_type_name[measurement->rate_pacer->schedule.type]);
+			printf("%s, target %.2lf ops/sec, achieved %.2lf ops/sec (%.2lf%%), late ops %ld (%.2lf%%), "
+			       "average lag %.2lf ns, max lag %ld ns", measurement->config.arrival_distribution.c_str(),
+			       target_throughput, total_throughput, target_throughput > 0 ? 100 * total_throughput / target_throughput : 0,
+			       nr_late_op, nr_measured_op > 0 ? 100 * (double) nr_late_op / (double) nr_measured_op : 0,
+			       nr_late_op > 0 ? total_lag / (double) nr_late_op : 0, max_lag);
+			if (measurement->rate_pacer != nullptr && measurement->rate_pacer->schedule.bucket_size > 0)
+				printf(", ops skipped by a full bucket %ld", measurement->rate_pacer->nr_skipped.load());
+			printf("\n");
+		}
+
+		/* print how far behind schedule each client fell */
+		printf("%s overall (schedule lag): ", task);
+		for (size_t id = 0; id < measurement->client_slot_arr.size(); ++id) {
+			ClientMeasurement *slot = measurement->client_slot_arr[id];
+			if (slot == nullptr)
+				continue;
+			double average_lag = slot->late_op_count == 0 ? 0 : slot->total_schedule_lag / (double) slot->late_op_count;
+			printf("client %zu late ops %ld average lag %.2lf ns max lag %ld ns; ", id,
+			       slot->late_op_count, average_lag, slot->max_schedule_lag);
+		}
+		printf("\n");
+	}
+
+	/* print slowest ops, relative to the phase start so they line up with the epochs */
+	if (!measurement->final_slow_op_arr.empty()) {
+		printf("%s slowest ops:\n", task);
+		for (size_t i = 0; i < measurement->final_slow_op_arr.size(); ++i) {
+			const SlowOp &slow_op = measurement->final_slow_op_arr[i];
+			printf("%s slow op %zu: %s latency %ld ns at %.6lf s, client %d, key %s, value size %ld\n", task, i,
+			       operation_type_name[slow_op.type], slow_op.latency,
+			       (double) (slow_op.start_timestamp - measurement->start_timestamp) / 1e9,
+			       slow_op.client_id, slow_op.key.c_str(), slow_op.value_size);
+		}
+	}
 	measurement->final_result_lock.unlock();
 	std::cout << std::flush;
 }
 
-void run_workload_with_op_measurement(const char *task, ClientFactory *factory, Workload **workload_arr, int nr_thread, long nr_op, long runtime_seconds, long max_progress,
-                                      long next_op_interval_ns, const char *latency_file) {
+/* trace.json -> trace.Zipfian_Warm-Up.json, so the phases of a run do not overwrite each other */
+static std::string phase_file_path(const std::string &file, const char *task, int repetition) {
+	std::string suffix;
+	for (const char *c = task; *c != '\0'; ++c) {
+		if (isalnum((unsigned char) *c) || *c == '-')
+			suffix += *c;
+		else if (!suffix.empty() && suffix.back() != '_')
+			suffix += '_';
+	}
+	while (!suffix.empty() && suffix.back() == '_')
+		suffix.pop_back();
+	if (repetition > 0)
+		suffix += "_" + std::to_string(repetition);
+	size_t slash = file.rfind('/');
+	size_t dot = file.rfind('.');
+	if (dot == std::string::npos || (slash != std::string::npos && dot < slash))
+		return file + "." + suffix;
+	return file.substr(0, dot) + "." + suffix + file.substr(dot);
+}
+
+PhaseResult run_workload_with_op_measurement(const char *task, ClientFactory *factory, Workload **workload_arr, int nr_thread, long nr_op, long runtime_seconds, long max_progress,
+                                             long next_op_interval_ns, const MeasurementConfig &measurement_config, int repetition) {
+	if (measurement_config.repetitions > 1)
+		printf("%s: repetition %d of %d\n", task, repetition + 1, measurement_config.repetitions);
+
 	/* allocate resources */
 	Client **client_arr = new Client *[nr_thread];
 	std::thread **thread_arr = new std::thread *[nr_thread];
-	OpMeasurement measurement;
+	/* the latency log is opened per phase, each gets its own file */
+	MeasurementConfig phase_config = measurement_config;
+	if (!phase_config.latency_file.empty())
+		phase_config.latency_file = phase_file_path(measurement_config.latency_file, task, repetition);
+	OpMeasurement measurement(phase_config);
+	measurement.set_max_progress(max_progress);
+	measurement.set_next_op_interval(next_op_interval_ns);
+	measurement.set_target_rate(measurement_config.target_ops_per_sec);
+	measurement.set_record_size(workload_arr[0]->key_size + workload_arr[0]->value_size);
+	measurement.set_popularity_range(workload_arr[0]->nr_ranked_key);
+	/* the workers of a rate schedule share one pacer, it restarts right before they do */
+	RatePacer *rate_pacer = nullptr;
+	if (measurement_config.rate_schedule.enabled()) {
+		rate_pacer = new RatePacer(measurement_config.rate_schedule);
+		measurement.set_rate_pacer(rate_pacer);
+	}
 	for (int thread_index = 0; thread_index < nr_thread; ++thread_index) {
 		client_arr[thread_index] = factory->create_client();
 		measurement.enable_client(client_arr[thread_index]->id);
 	}
 
+	PageCacheSampler *page_cache_sampler = nullptr;
+	if (measurement_config.page_cache_interval_ms > 0) {
+		if (measurement_config.data_dir.empty()) {
+			fprintf(stderr, "run_workload_with_op_measurement: page cache sampling needs measurement.data_dir\n");
+		} else {
+			page_cache_sampler = new PageCacheSampler(task, measurement_config.data_dir, measurement_config.page_cache_interval_ms,
+			                                          measurement_config.page_cache_by_group, factory,
+			                                          measurement_config.page_cache_file);
+			measurement.page_cache_sampler = page_cache_sampler;
+			page_cache_sampler->start();
+		}
+	}
+
+	/* per-worker schedules, an open-loop target rate takes precedence over next_op_interval_ns */
+	std::vector<ArrivalProcess> arrival_arr;
+	for (int thread_index = 0; thread_index < nr_thread; ++thread_index) {
+		if (rate_pacer != nullptr)
+			/* only draws unit gaps, the pacer scales them to the current rate */
+			arrival_arr.emplace_back(ArrivalProcess::parse_distribution(measurement_config.arrival_distribution), 1,
+			                         (uint64_t) (thread_index + repetition * nr_thread));
+		else if (measurement_config.target_ops_per_sec > 0)
+			arrival_arr.emplace_back(ArrivalProcess::parse_distribution(measurement_config.arrival_distribution),
+			                         1e9 * nr_thread / measurement_config.target_ops_per_sec,
+			                         (uint64_t) (thread_index + repetition * nr_thread));
+		else
+			arrival_arr.emplace_back(ARRIVAL_DETERMINISTIC, (double) next_op_interval_ns, 0);
+	}
+
+	if (rate_pacer != nullptr)
+		rate_pacer->start(Timer::now_ns());
+
 	/* start running workload */
-	measurement.set_max_progress(max_progress);
 	for (int thread_index = 0; thread_index < nr_thread; ++thread_index) {
-		thread_arr[thread_index] = new std::thread(worker_thread_fn, client_arr[thread_index], workload_arr[thread_index], &measurement, next_op_interval_ns);
+		thread_arr[thread_index] = new std::thread(worker_thread_fn, client_arr[thread_index], workload_arr[thread_index], &measurement, &arrival_arr[(size_t) thread_index]);
 	}
-	std::thread stat_thread(monitor_thread_fn, task, &measurement, runtime_seconds);
+	std::thread stat_thread(monitor_thread_fn, task, factory, &measurement, runtime_seconds);
 	for (int thread_index = 0; thread_index < nr_thread; ++thread_index) {
 		thread_arr[thread_index]->join();
 	}
 	measurement.finalize_measure();
-	if (latency_file != nullptr)
-		measurement.save_latency(latency_file);
 	stat_thread.join();
+	delete page_cache_sampler;
+	delete rate_pacer;
+	if (measurement.tracer != nullptr)
+		measurement.tracer->write_json(phase_file_path(measurement_config.trace_file, task, repetition).c_str(), task);
+
+	PhaseResult result;
+	result.task = task;
+	result.repetition = repetition;
+	result.duration = std::chrono::duration<double>(measurement.end_time - measurement.start_time).count();
+	for (int i = 0; i < NR_OP_TYPE; ++i) {
+		result.throughput_arr[i] = measurement.get_throughput((OperationType) i);
+	}
+	result.latency_hist = measurement.final_latency_hist;
+	if (measurement.record_response_time)
+		result.response_hist = measurement.final_response_hist;
+	if (!measurement_config.result_file.empty()) {
+		FILE *result_file = fopen(measurement_config.result_file.c_str(), "a");
+		if (result_file == nullptr) {
+			fprintf(stderr, "run_workload_with_op_measurement: failed to open result file %s\n", measurement_config.result_file.c_str());
+		} else {
+			result.save(result_file);
+			fclose(result_file);
+		}
+	}
 
 	/* cleanup */
 	for (int thread_index = 0; thread_index < nr_thread; ++thread_index) {
@@ -128,6 +705,14 @@ void run_workload_with_op_measurement(const char *task, ClientFactory *factory,
 	}
 	delete[] client_arr;
 	delete[] thread_arr;
+	if (measurement_config.repetitions > 1) {
+		char phase_label[256];
+		snprintf(phase_label, sizeof(phase_label), "%s repetition %d", task, repetition + 1);
+		factory->report_phase(phase_label);
+	} else {
+		factory->report_phase(task);
+	}
+	return result;
 }
 
 void run_init_workload_with_op_measurement(const char *task, ClientFactory *factory, long nr_entry, long key_size, long value_size, int nr_thread) {
@@ -139,7 +724,7 @@ void run_init_workload_with_op_measurement(const char *task, ClientFactory *fact
 		workload_arr[thread_index] = new InitWorkload(end_key - start_key, start_key, key_size, value_size, thread_index);
 	}
 
-	run_workload_with_op_measurement(task, factory, (Workload **)workload_arr, nr_thread, nr_entry, 0, nr_entry, 0, nullptr);
+	run_workload_with_op_measurement(task, factory, (Workload **)workload_arr, nr_thread, nr_entry, 0, nr_entry, 0, MeasurementConfig());
 
 	for (int thread_index = 0; thread_index < nr_thread; ++thread_index) {
 		delete workload_arr[thread_index];
@@ -152,93 +737,187 @@ void run_init_trace_workload_with_op_measurement(const char *task, ClientFactory
 	int64_t nr_op = workload->nr_op;
 	int nr_thread = 1;
 	fprintf(stderr, "nr_op: %ld\n", nr_op);
-	run_workload_with_op_measurement(task, factory, (Workload **)&workload, nr_thread, nr_op, 0, nr_thread * nr_op, 0, nullptr);
+	run_workload_with_op_measurement(task, factory, (Workload **)&workload, nr_thread, nr_op, 0, nr_thread * nr_op, 0, MeasurementConfig());
 	delete workload;
 }
 
-void run_uniform_workload_with_op_measurement(const char *task, ClientFactory *factory, long nr_entry, long key_size, long value_size,
-                                              long scan_length, int nr_thread, struct OpProportion op_prop, long nr_op, long runtime_seconds, long next_op_interval_ns,
-                                              const char *latency_file) {
-	UniformWorkload **workload_arr = new UniformWorkload *[nr_thread];
-	for (unsigned int thread_index = 0; thread_index < nr_thread; ++thread_index) {
-		workload_arr[thread_index] = new UniformWorkload(key_size, value_size, scan_length, nr_entry, nr_op, op_prop, thread_index);
+/* prints mean, stddev and 95% confidence interval of a phase that ran more than once */
+static void report_repetitions(const char *task, const std::vector<PhaseResult> &result_arr) {
+	if (result_arr.size() < 2)
+		return;
+	std::vector<double> total_throughput_arr;
+	for (const PhaseResult &result : result_arr)
+		total_throughput_arr.push_back(result.get_total_throughput());
+	SampleStats total_throughput(total_throughput_arr);
+	printf("%s repetitions (%zu): total throughput mean %.2lf ops/sec, stddev %.2lf, 95%% CI %.2lf-%.2lf ops/sec\n",
+	       task, result_arr.size(), total_throughput.mean, total_throughput.stddev,
+	       total_throughput.mean - total_throughput.ci95, total_throughput.mean + total_throughput.ci95);
+	const double percentile_arr[] = {0.5, 0.99, 0.999};
+	const char *percentile_name_arr[] = {"p50", "p99", "p99.9"};
+	for (size_t i = 0; i < NR_OP_TYPE; ++i) {
+		std::vector<double> throughput_arr;
+		for (const PhaseResult &result : result_arr)
+			throughput_arr.push_back(result.throughput_arr[i]);
+		SampleStats throughput(throughput_arr);
+		if (throughput.mean == 0)
+			continue;
+		printf("%s repetitions (%zu): %s throughput mean %.2lf ops/sec, stddev %.2lf, 95%% CI +-%.2lf", task,
+		       result_arr.size(), operation_type_name[i], throughput.mean, throughput.stddev, throughput.ci95);
+		for (int j = 0; j < 3; ++j) {
+			std::vector<double> latency_arr;
+			for (const PhaseResult &result : result_arr)
+				latency_arr.push_back(result.latency_hist[i].get_percentile(percentile_arr[j]));
+			SampleStats latency(latency_arr);
+			printf(", %s latency mean %.0lf ns, stddev %.0lf, 95%% CI +-%.0lf", percentile_name_arr[j],
+			       latency.mean, latency.stddev, latency.ci95);
+		}
+		printf("\n");
+	}
+}
+
+/*
+ * runs the measured phase, run_phase runs it once on fresh workloads seeded by the repetition
+ *
+ * with an slo search, probe_seconds probes at the rates the search picks take
+ * the place of the repetitions. each probe runs as its own task, e.g.
+ * "Zipfian/probe3@12000", so result files never pool probes of different rates
+ * as repetitions. returns the results of the repetitions, or the result of the
+ * knee probe.
+ */
+static std::vector<PhaseResult> run_measured_phase(const char *task, long runtime_seconds, const MeasurementConfig &measurement_config,
+                                                   const std::function<PhaseResult(const char *, long, const MeasurementConfig &, int)> &run_phase) {
+	std::vector<PhaseResult> result_arr;
+	if (measurement_config.slo_search.enabled()) {
+		std::vector<SloProbe> probe_arr = search_max_throughput(task, measurement_config.slo_search,
+		                                                        [&](double target_ops_per_sec, int probe) {
+			MeasurementConfig probe_config = measurement_config;
+			probe_config.target_ops_per_sec = target_ops_per_sec;
+			probe_config.repetitions = 1;
+			char probe_task[256];
+			snprintf(probe_task, sizeof(probe_task), "%s/probe%d@%.0f", task, probe, target_ops_per_sec);
+			result_arr.push_back(run_phase(probe_task, measurement_config.slo_search.probe_seconds, probe_config, probe));
+			return result_arr.back();
+		});
+		for (const SloProbe &probe : probe_arr) {
+			if (probe.is_knee)
+				return {result_arr[(size_t) probe.probe]};
+		}
+		return {};
 	}
+	for (int repetition = 0; repetition < measurement_config.repetitions; ++repetition)
+		result_arr.push_back(run_phase(task, runtime_seconds, measurement_config, repetition));
+	report_repetitions(task, result_arr);
+	return result_arr;
+}
 
-	run_workload_with_op_measurement(task, factory, (Workload **)workload_arr, nr_thread, nr_op, runtime_seconds, nr_thread * nr_op, next_op_interval_ns, latency_file);
+std::vector<PhaseResult> run_uniform_workload_with_op_measurement(const char *task, ClientFactory *factory, long nr_entry, long key_size, long value_size,
+                                                                  long scan_length, int nr_thread, struct OpProportion op_prop, long nr_op, long runtime_seconds, long next_op_interval_ns,
+                                                                  const MeasurementConfig &measurement_config) {
+	return run_measured_phase(task, runtime_seconds, measurement_config,
+	                          [&](const char *phase_task, long phase_runtime_seconds, const MeasurementConfig &phase_config, int repetition) {
+		UniformWorkload **workload_arr = new UniformWorkload *[nr_thread];
+		for (unsigned int thread_index = 0; thread_index < nr_thread; ++thread_index) {
+			/* fresh seeds per repetition, otherwise every repetition replays the same ops */
+			workload_arr[thread_index] = new UniformWorkload(key_size, value_size, scan_length, nr_entry, nr_op, op_prop,
+			                                                 thread_index + (unsigned int) (repetition * nr_thread));
+		}
 
-	for (int thread_index = 0; thread_index < nr_thread; ++thread_index) {
-		delete workload_arr[thread_index];
+		PhaseResult result = run_workload_with_op_measurement(phase_task, factory, (Workload **)workload_arr, nr_thread, nr_op, phase_runtime_seconds,
+		                                                      nr_thread * nr_op, next_op_interval_ns, phase_config, repetition);
+
+		for (int thread_index = 0; thread_index < nr_thread; ++thread_index) {
+			delete workload_arr[thread_index];
+		}
+		delete[] workload_arr;
+		return result;
+	});
+}
+
+/* merges the per-thread key sketches into the first one, prints it and frees them all */
+static void report_key_sketch(const char *task, Workload **workload_arr, int nr_thread) {
+	KeySketch *key_sketch = workload_arr[0]->key_sketch;
+	if (key_sketch == nullptr)
+		return;
+	for (int thread_index = 1; thread_index < nr_thread; ++thread_index) {
+		key_sketch->merge(*workload_arr[thread_index]->key_sketch);
+		delete workload_arr[thread_index]->key_sketch;
+		workload_arr[thread_index]->key_sketch = nullptr;
 	}
-	delete[] workload_arr;
+	key_sketch->print_report(task, 10);
+	delete key_sketch;
+	workload_arr[0]->key_sketch = nullptr;
 }
 
-void run_zipfian_workload_with_op_measurement(const char *task, ClientFactory *factory, long nr_entry, long key_size, long value_size,
-                                              long scan_length, int nr_thread, struct OpProportion op_prop, double zipfian_constant, long nr_op,
-											  long runtime_seconds, long next_op_interval_ns, const char *latency_file) {
+std::vector<PhaseResult> run_zipfian_workload_with_op_measurement(const char *task, ClientFactory *factory, long nr_entry, long key_size, long value_size,
+                                                                  long scan_length, int nr_thread, struct OpProportion op_prop, double zipfian_constant, long nr_op,
+											  long runtime_seconds, long next_op_interval_ns, const MeasurementConfig &measurement_config) {
 	//int scan_worker_count = 1;
-	ZipfianWorkload **workload_arr = new ZipfianWorkload *[nr_thread];
 	printf("ZipfianWorkload: start initializing zipfian variables, might take a while\n");
 	ZipfianWorkload base_workload(key_size, value_size, scan_length, nr_entry, nr_op, op_prop, zipfian_constant, 0);
-	base_workload.record_keys = true;
-	for (unsigned int thread_index = 0; thread_index < nr_thread; ++thread_index) {
-		workload_arr[thread_index] = base_workload.clone(thread_index);
-		// if (scan_worker_count > 0 && thread_index < scan_worker_count && op_prop.op[SCAN] > 0) {
-		// 	workload_arr[thread_index]->do_only_scans = true;
-		// } else {
-		// 	workload_arr[thread_index]->do_only_scans = false;
-		// }
-	}
-
-	run_workload_with_op_measurement(task, factory, (Workload **)workload_arr, nr_thread, nr_op, runtime_seconds, nr_thread * nr_op, next_op_interval_ns, latency_file);
-
-	// // If record_keys is set, dump all keys into a file.
-	// // Format as a json array of numbers.
-	// if (base_workload.record_keys) {
-	// 	std::ofstream key_file("workload_keys.json");
-	// 	key_file << "[";
-    //             for (int i = 0; i < nr_thread; i++) {
-	// 				auto &workload = workload_arr[i];
-    //                 for (auto it = workload->recorded_keys.begin();
-    //                      it != workload->recorded_keys.end(); ++it) {
-    //                     key_file << *it;
-    //                     if (std::next(it) != workload->recorded_keys.end()) {
-    //                         key_file << ",";
-    //                     }
-    //                 }
-    //             }
-    //             key_file << "]";
-	// 	key_file.close();
-	// }
+	return run_measured_phase(task, runtime_seconds, measurement_config,
+	                          [&](const char *phase_task, long phase_runtime_seconds, const MeasurementConfig &phase_config, int repetition) {
+		ZipfianWorkload **workload_arr = new ZipfianWorkload *[nr_thread];
+		for (unsigned int thread_index = 0; thread_index < nr_thread; ++thread_index) {
+			workload_arr[thread_index] = base_workload.clone(thread_index + (unsigned int) (repetition * nr_thread));
+			if (measurement_config.key_sketch_top_k > 0)
+				workload_arr[thread_index]->key_sketch = new KeySketch(measurement_config.key_sketch_top_k);
+			// if (scan_worker_count > 0 && thread_index < scan_worker_count && op_prop.op[SCAN] > 0) {
+			// 	workload_arr[thread_index]->do_only_scans = true;
+			// } else {
+			// 	workload_arr[thread_index]->do_only_scans = false;
+			// }
+		}
 
-	for (int thread_index = 0; thread_index < nr_thread; ++thread_index) {
-		delete workload_arr[thread_index];
-	}
-	delete[] workload_arr;
+		PhaseResult result = run_workload_with_op_measurement(phase_task, factory, (Workload **)workload_arr, nr_thread, nr_op, phase_runtime_seconds,
+		                                                      nr_thread * nr_op, next_op_interval_ns, phase_config, repetition);
+
+		report_key_sketch(phase_task, (Workload **)workload_arr, nr_thread);
+
+		for (int thread_index = 0; thread_index < nr_thread; ++thread_index) {
+			delete workload_arr[thread_index];
+		}
+		delete[] workload_arr;
+		return result;
+	});
 }
 
-void run_latest_workload_with_op_measurement(const char *task, ClientFactory *factory, long nr_entry, long key_size, long value_size,
-                                             int nr_thread, double read_ratio, double zipfian_constant, long nr_op, long runtime_seconds,
-											 long next_op_interval_ns, const char *latency_file) {
-	LatestWorkload **workload_arr = new LatestWorkload *[nr_thread];
+std::vector<PhaseResult> run_latest_workload_with_op_measurement(const char *task, ClientFactory *factory, long nr_entry, long key_size, long value_size,
+                                                                 int nr_thread, double read_ratio, double zipfian_constant, long nr_op, long runtime_seconds,
+											 long next_op_interval_ns, const MeasurementConfig &measurement_config) {
 	printf("LatestWorkload: start initializing zipfian variables, might take a while\n");
 	LatestWorkload base_workload(key_size, value_size, nr_entry, nr_op, read_ratio, zipfian_constant, 0);
-	for (unsigned int thread_index = 0; thread_index < nr_thread; ++thread_index) {
-		workload_arr[thread_index] = base_workload.clone(thread_index);
-	}
+	return run_measured_phase(task, runtime_seconds, measurement_config,
+	                          [&](const char *phase_task, long phase_runtime_seconds, const MeasurementConfig &phase_config, int repetition) {
+		LatestWorkload **workload_arr = new LatestWorkload *[nr_thread];
+		for (unsigned int thread_index = 0; thread_index < nr_thread; ++thread_index) {
+			workload_arr[thread_index] = base_workload.clone(thread_index + (unsigned int) (repetition * nr_thread));
+			if (measurement_config.key_sketch_top_k > 0)
+				workload_arr[thread_index]->key_sketch = new KeySketch(measurement_config.key_sketch_top_k);
+		}
 
-	run_workload_with_op_measurement(task, factory, (Workload **)workload_arr, nr_thread, nr_op, runtime_seconds, nr_thread * nr_op, next_op_interval_ns, latency_file);
+		PhaseResult result = run_workload_with_op_measurement(phase_task, factory, (Workload **)workload_arr, nr_thread, nr_op, phase_runtime_seconds,
+		                                                      nr_thread * nr_op, next_op_interval_ns, phase_config, repetition);
 
-	for (int thread_index = 0; thread_index < nr_thread; ++thread_index) {
-		delete workload_arr[thread_index];
-	}
-	delete[] workload_arr;
+		report_key_sketch(phase_task, (Workload **)workload_arr, nr_thread);
+
+		for (int thread_index = 0; thread_index < nr_thread; ++thread_index) {
+			delete workload_arr[thread_index];
+		}
+		delete[] workload_arr;
+		return result;
+	});
 }
 
 TraceIterator *global_trace_iter = nullptr;
 
 void run_trace_workload_with_op_measurement(const char *task, ClientFactory *factory, long key_size, long value_size,
                                             int nr_thread, std::string trace_file, std::string trace_type, long runtime_seconds,
-											long next_op_interval_ns, const char *latency_file) {
+											long next_op_interval_ns, const MeasurementConfig &measurement_config) {
+	/* the trace is a single stream shared by every phase, it cannot be replayed per repetition or probe */
+	if (measurement_config.repetitions > 1 || measurement_config.slo_search.enabled()) {
+		fprintf(stderr, "run_trace_workload_with_op_measurement: repetitions and slo_search are not supported for trace workloads\n");
+		throw std::invalid_argument("unsupported measurement config for trace workload");
+	}
 	TraceWorkload **workload_arr = new TraceWorkload *[nr_thread];
 	// Create a new TraceWorkload object shared by all threads. Use new operator
 	// to allocate memory for the object.
@@ -256,7 +935,7 @@ void run_trace_workload_with_op_measurement(const char *task, ClientFactory *fac
 		workload_arr[thread_index]->trace_iterator = trace_iter;
 	}
 
-	run_workload_with_op_measurement(task, factory, (Workload **)workload_arr, nr_thread, nr_op, runtime_seconds, nr_thread * nr_op, next_op_interval_ns, latency_file);
+	run_workload_with_op_measurement(task, factory, (Workload **)workload_arr, nr_thread, nr_op, runtime_seconds, nr_thread * nr_op, next_op_interval_ns, measurement_config);
 
 	for (int thread_index = 0; thread_index < nr_thread; ++thread_index) {
 		delete workload_arr[thread_index];
@@ -1,6 +1,7 @@
 #include <vector>
 #include <random>
 #include <algorithm>
+#include <map>
 #include "workload.h"
 // for sys_gettid
 #include <unistd.h>
@@ -79,6 +80,22 @@ void UniformWorkload::generate_value_string(char *value_buffer) {
 	value_buffer[this->value_size - 1] = '\0';
 }
 
+/* zeta(n, theta) is O(n), cached so sweep points and phases with the same skew compute it once */
+static double zipfian_zeta(long nr_entry, double zipfian_constant) {
+	static std::mutex zeta_lock;
+	static std::map<std::pair<long, double>, double> zeta_map;
+	std::lock_guard<std::mutex> guard(zeta_lock);
+	auto zeta_it = zeta_map.find({nr_entry, zipfian_constant});
+	if (zeta_it != zeta_map.end())
+		return zeta_it->second;
+	double zeta = 0;
+	for (long i = 1; i < nr_entry + 1; ++i) {
+		zeta += 1.0 / (pow((double) i, zipfian_constant));
+	}
+	zeta_map[{nr_entry, zipfian_constant}] = zeta;
+	return zeta;
+}
+
 ZipfianWorkload::ZipfianWorkload(long key_size, long value_size, long scan_length, long nr_entry, long nr_op,
                                  struct OpProportion op_prop, double zipfian_constant, unsigned int seed)
 : Workload(key_size, value_size), scan_length(scan_length), nr_entry(nr_entry), nr_op(nr_op), op_prop(op_prop),
@@ -86,10 +103,7 @@ ZipfianWorkload::ZipfianWorkload(long key_size, long value_size, long scan_lengt
 	sprintf(this->key_format, "%%0%ldlu", key_size - 1);
 
 	/* zipfian-related initialization */
-	this->zetan = 0;
-	for (long i = 1; i < this->nr_entry + 1; ++i) {
-		this->zetan += 1.0 / (pow((double) i, this->zipfian_constant));
-	}
+	this->zetan = zipfian_zeta(this->nr_entry, this->zipfian_constant);
 	this->theta = this->zipfian_constant;
 	this->zeta2theta = 0;
 	for (long i = 1; i < 3; ++i) {
@@ -99,6 +113,7 @@ ZipfianWorkload::ZipfianWorkload(long key_size, long value_size, long scan_lengt
 	this->eta = (1 - pow(2.0 / (double) this->nr_entry, 1 - this->theta))
 	            / (1 - (this->zeta2theta / this->zetan));
 	this->generate_zipfian_random_ulong(true);
+	this->nr_ranked_key = this->nr_entry;
 }
 
 bool ZipfianWorkload::has_next_op() {
@@ -170,11 +185,13 @@ void ZipfianWorkload::next_op(Operation *op) {
 		printf("op_prop = %f, %f, %f, %f, %f\n", this->op_prop.op[UPDATE], this->op_prop.op[INSERT], this->op_prop.op[READ], this->op_prop.op[SCAN], this->op_prop.op[READ_MODIFY_WRITE]);
 		throw std::invalid_argument("failed to generate an operation");
 	}
-	unsigned long key = this->generate_zipfian_random_ulong(true) % ((unsigned long) this->nr_entry);
-	// If record_keys is set to true, record op's key
-	if (this->record_keys) {
-		this->recorded_keys.push_back(key);
-	}
+	/* the rank before hashing is the key's popularity, the hash scatters it over the key space */
+	unsigned long rank = this->generate_zipfian_random_ulong(false);
+	/* generate_zipfian_random_ulong(true) returns ranks 0 and 1 unhashed, keep those keys */
+	unsigned long key = (rank < 2 ? rank : ZipfianWorkload::fnv1_64_hash(rank)) % ((unsigned long) this->nr_entry);
+	op->popularity_rank = (long) rank;
+	if (this->key_sketch != nullptr)
+		this->key_sketch->record(key);
 	this->generate_key_string(op->key_buffer, key);
 	++this->cur_nr_op;
 	op->is_last_op = !this->has_next_op();
@@ -190,7 +207,7 @@ ZipfianWorkload * ZipfianWorkload::clone(unsigned int new_seed) {
 	copy->alpha = this->alpha;
 	copy->eta = this->eta;
 	copy->nr_entry = this->nr_entry;
-	copy->record_keys = this->record_keys;
+	copy->nr_ranked_key = this->nr_ranked_key;
 	return copy;
 }
 
@@ -280,10 +297,7 @@ LatestWorkload::LatestWorkload(long key_size, long value_size, long nr_entry, lo
 	sprintf(this->key_format, "%%0%ldlu", key_size - 1);
 
 	/* zipfian-related initialization */
-	this->zetan = 0;
-	for (long i = 1; i < this->nr_entry + 1; ++i) {
-		this->zetan += 1.0 / (pow((double) i, this->zipfian_constant));
-	}
+	this->zetan = zipfian_zeta(this->nr_entry, this->zipfian_constant);
 	this->theta = this->zipfian_constant;
 	this->zeta2theta = 0;
 	for (long i = 1; i < 3; ++i) {
@@ -322,6 +336,8 @@ void LatestWorkload::next_op(Operation *op) {
 		}
 	}
 	key = LatestWorkload::fnv1_64_hash(key) % ((unsigned long) this->nr_entry);
+	if (this->key_sketch != nullptr)
+		this->key_sketch->record(key);
 	this->generate_key_string(op->key_buffer, key);
 	if (!read)
 		this->generate_value_string(op->value_buffer);
@@ -4,6 +4,7 @@
 #include <string>
 #include <list>
 #include "yaml-cpp/yaml.h"
+#include "measurement_config.h"
 
 using std::string;
 using std::list;
@@ -23,6 +24,7 @@ struct IOTraceConfig {
 		string data_dir;
 		bool print_stats;
 	} io_trace;
+	MeasurementConfig measurement;
 
 	static IOTraceConfig parse_yaml(YAML::Node &root);
 };
@@ -44,6 +46,11 @@ IOTraceConfig IOTraceConfig::parse_yaml(YAML::Node &root) {
 	config.io_trace.data_dir = io_trace["data_dir"].as<string>();
 	config.io_trace.print_stats = io_trace["print_stats"].as<bool>();
 
+	config.measurement = MeasurementConfig::parse_yaml(root);
+	/* the trace replays against files in data_dir, so sample that */
+	if (config.measurement.data_dir.empty())
+		config.measurement.data_dir = config.io_trace.data_dir;
+
 	return config;
 }
 
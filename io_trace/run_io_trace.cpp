@@ -42,6 +42,7 @@ int main(int argc, char *argv[]) {
 			nr_op = config.workload.nr_op;
 			runtime_seconds = config.workload.runtime_seconds;
 		}
+		MeasurementConfig measurement_config = config.measurement.for_phase(i == 0);
 		if (config.workload.request_distribution == "trace") {
 			run_trace_workload_with_op_measurement(i == 0 ? "Trace (Warm-Up)" : "Trace",
 			                                       &factory,
@@ -52,7 +53,7 @@ int main(int argc, char *argv[]) {
 			                                       "google_bench",
 			                                       runtime_seconds,
 			                                       config.workload.next_op_interval_ns,
-			                                       nullptr);
+			                                       measurement_config);
 		} else {
 			throw std::invalid_argument("unrecognized workload");
 		}
@@ -230,6 +230,36 @@ void LevelDBFactory::reset_stats() {
 	// no-op
 }
 
+void LevelDBFactory::sample_stats(std::vector<BackendStat> *stat_arr) {
+	/* leveldb has no tickers, per-level compaction totals come from the leveldb.stats table */
+	std::string stats;
+	if (this->db->GetProperty("leveldb.stats", &stats)) {
+		double compaction_seconds = 0, compaction_read_mb = 0, compaction_write_mb = 0;
+		size_t pos = stats.find("---");
+		pos = pos == std::string::npos ? stats.size() : stats.find('\n', pos);
+		while (pos != std::string::npos && pos < stats.size()) {
+			int level, nr_file;
+			double size_mb, seconds, read_mb, write_mb;
+			if (sscanf(stats.c_str() + pos + 1, "%d %d %lf %lf %lf %lf", &level, &nr_file, &size_mb, &seconds,
+			           &read_mb, &write_mb) != 6)
+				break;
+			std::string prefix = "leveldb.level" + std::to_string(level);
+			stat_arr->push_back({prefix + ".files", (double) nr_file, false});
+			stat_arr->push_back({prefix + ".bytes", size_mb * 1048576, false});
+			compaction_seconds += seconds;
+			compaction_read_mb += read_mb;
+			compaction_write_mb += write_mb;
+			pos = stats.find('\n', pos + 1);
+		}
+		stat_arr->push_back({"leveldb.compaction.micros", compaction_seconds * 1e6, true});
+		stat_arr->push_back({"leveldb.compaction.read.bytes", compaction_read_mb * 1048576, true});
+		stat_arr->push_back({"leveldb.compaction.write.bytes", compaction_write_mb * 1048576, true});
+	}
+	std::string memory_usage;
+	if (this->db->GetProperty("leveldb.approximate-memory-usage", &memory_usage))
+		stat_arr->push_back({"leveldb.approximate-memory-usage", std::stod(memory_usage), false});
+}
+
 LevelDBClient * LevelDBFactory::create_client() {
 	auto client = new LevelDBClient(this, this->client_id++);
 	// client->scan_thread_pool_ = this->scan_thread_pool_;
@@ -240,3 +270,31 @@ void LevelDBFactory::destroy_client(Client *client) {
 	LevelDBClient *leveldb_client = static_cast<LevelDBClient *>(client);
 	delete leveldb_client;
 }
+
+void LevelDBFactory::get_file_groups(std::map<std::string, std::string> *file_group_map) {
+	/* leveldb.sstables lists "--- level N ---" headers followed by " number:size[...]" lines */
+	std::string sstables;
+	if (!this->db->GetProperty("leveldb.sstables", &sstables))
+		return;
+	std::string level;
+	size_t pos = 0;
+	while (pos < sstables.size()) {
+		size_t end = sstables.find('\n', pos);
+		if (end == std::string::npos)
+			end = sstables.size();
+		const char *line = sstables.c_str() + pos;
+		int level_number;
+		unsigned long long file_number;
+		char file_name[32];
+		if (sscanf(line, "--- level %d ---", &level_number) == 1) {
+			level = "L" + std::to_string(level_number);
+		} else if (!level.empty() && sscanf(line, " %llu:", &file_number) == 1) {
+			/* table files are .ldb, older databases still have .sst */
+			snprintf(file_name, sizeof(file_name), "%06llu.ldb", file_number);
+			(*file_group_map)[file_name] = level;
+			snprintf(file_name, sizeof(file_name), "%06llu.sst", file_number);
+			(*file_group_map)[file_name] = level;
+		}
+		pos = end + 1;
+	}
+}
@@ -46,6 +46,8 @@ struct LevelDBFactory : public ClientFactory {
 	void destroy_client(Client *client) override;
 	void do_print_stats();
 	void reset_stats();
+	void sample_stats(std::vector<BackendStat> *stat_arr) override;
+	void get_file_groups(std::map<std::string, std::string> *file_group_map) override;
 };
 
 #endif //YCSB_WT_CLIENT_H
@@ -4,6 +4,8 @@
 #include <string>
 #include <list>
 #include "yaml-cpp/yaml.h"
+#include "measurement_config.h"
+#include "sweep.h"
 
 using std::string;
 using std::list;
@@ -40,6 +42,8 @@ struct LevelDBConfig {
 		long long cache_size;
 		bool print_stats;
 	} leveldb;
+	MeasurementConfig measurement;
+	SweepConfig sweep;
 
 	static LevelDBConfig parse_yaml(YAML::Node &root);
 };
@@ -84,6 +88,12 @@ LevelDBConfig LevelDBConfig::parse_yaml(YAML::Node &root) {
 	config.leveldb.cache_size = leveldb["cache_size"].as<long long>();
 	config.leveldb.print_stats = leveldb["print_stats"].as<bool>();
 
+	config.measurement = MeasurementConfig::parse_yaml(root);
+	config.sweep = SweepConfig::parse_yaml(root);
+	/* sample i/o of the device the database lives on unless told otherwise */
+	if (config.measurement.data_dir.empty())
+		config.measurement.data_dir = config.leveldb.data_dir;
+
 	return config;
 }
 
@@ -87,11 +87,24 @@ void MemcachedClient::set_last_reply(char *reply) {
 	this->last_reply = reply;
 }
 
+const std::vector<std::string> MemcachedFactory::stat_counter_default_list = {
+	"cmd_get", "cmd_set", "get_hits", "get_misses", "evictions", "bytes_read", "bytes_written",
+};
+const std::vector<std::string> MemcachedFactory::stat_gauge_default_list = {
+	"bytes", "curr_items", "limit_maxbytes", "curr_connections",
+};
+
 MemcachedFactory::MemcachedFactory(const char *memcached_addr, int memcached_port)
-: memcached_addr(memcached_addr), memcached_port(memcached_port), client_id(0) {
+: memcached_addr(memcached_addr), memcached_port(memcached_port), client_id(0),
+  server_stats_enabled(false), stat_context(nullptr) {
 	;
 }
 
+MemcachedFactory::~MemcachedFactory() {
+	if (this->stat_context != nullptr)
+		memcached_free(this->stat_context);
+}
+
 MemcachedClient *MemcachedFactory::create_client() {
 	MemcachedClient *client = new MemcachedClient(this, this->client_id++);
 	return client;
@@ -102,3 +115,59 @@ void MemcachedFactory::destroy_client(Client *client) {
 	memcached_client->close();
 	delete memcached_client;
 }
+
+void MemcachedFactory::enable_server_stats(const std::list<std::string> &counter_list,
+                                           const std::list<std::string> &gauge_list) {
+	/* empty lists keep the defaults */
+	this->server_stats_enabled = true;
+	if (counter_list.empty())
+		this->stat_counter_list = MemcachedFactory::stat_counter_default_list;
+	else
+		this->stat_counter_list.assign(counter_list.begin(), counter_list.end());
+	if (gauge_list.empty())
+		this->stat_gauge_list = MemcachedFactory::stat_gauge_default_list;
+	else
+		this->stat_gauge_list.assign(gauge_list.begin(), gauge_list.end());
+}
+
+void MemcachedFactory::sample_stats(std::vector<BackendStat> *stat_arr) {
+	if (!this->server_stats_enabled)
+		return;
+	if (this->stat_context == nullptr) {
+		char config[MEMCACHED_MAX_CONFIG_LEN];
+		snprintf(config, sizeof(config), "--SERVER=%s:%d", this->memcached_addr, this->memcached_port);
+		this->stat_context = memcached(config, strlen(config));
+		if (this->stat_context == nullptr) {
+			fprintf(stderr, "MemcachedFactory: failed to create stats context, server stats disabled\n");
+			this->server_stats_enabled = false;
+			return;
+		}
+	}
+	memcached_return_t rc;
+	memcached_stat_st *stat = memcached_stat(this->stat_context, nullptr, &rc);
+	if (stat == nullptr || rc != MEMCACHED_SUCCESS) {
+		fprintf(stderr, "MemcachedFactory: stats failed: %s, server stats disabled\n",
+		        memcached_strerror(this->stat_context, rc));
+		if (stat != nullptr)
+			memcached_stat_free(this->stat_context, stat);
+		this->server_stats_enabled = false;
+		return;
+	}
+	/* a single server, so the first entry has all of it */
+	for (int i = 0; i < 2; ++i) {
+		const std::vector<std::string> &name_list = i == 0 ? this->stat_counter_list : this->stat_gauge_list;
+		for (const std::string &name : name_list) {
+			char *value = memcached_stat_get_value(this->stat_context, stat, name.c_str(), &rc);
+			if (value == nullptr)
+				continue;
+			if (rc == MEMCACHED_SUCCESS)
+				stat_arr->push_back({name, strtod(value, nullptr), i == 0});
+			free(value);
+		}
+	}
+	memcached_stat_free(this->stat_context, stat);
+}
+
+bool MemcachedFactory::stats_in_epoch_annotation() {
+	return this->server_stats_enabled;
+}
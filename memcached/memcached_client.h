@@ -2,6 +2,10 @@
 #define YCSB_MEMCACHED_CLIENT_H
 
 #include <cstring>
+#include <list>
+#include <map>
+#include <string>
+#include <vector>
 #include <libmemcached/memcached.h>
 #include "client.h"
 
@@ -29,10 +33,25 @@ struct MemcachedFactory : public ClientFactory {
 	const char *memcached_addr;
 	const int memcached_port;
 	std::atomic<int> client_id;
+	/*
+	 * "stats" polled by the monitor on a context of its own, opened on first
+	 * use so the measured clients never share it
+	 */
+	bool server_stats_enabled;
+	memcached_st *stat_context;
+	std::vector<std::string> stat_counter_list;
+	std::vector<std::string> stat_gauge_list;
+
+	static const std::vector<std::string> stat_counter_default_list;
+	static const std::vector<std::string> stat_gauge_default_list;
 
 	MemcachedFactory(const char *memcached_addr, int memcached_port);
+	~MemcachedFactory();
 	MemcachedClient *create_client() override;
 	void destroy_client(Client *client) override;
+	void enable_server_stats(const std::list<std::string> &counter_list, const std::list<std::string> &gauge_list);
+	bool stats_in_epoch_annotation() override;
+	void sample_stats(std::vector<BackendStat> *stat_arr) override;
 };
 
 #endif //YCSB_MEMCACHED_CLIENT_H
@@ -2,9 +2,13 @@
 #define YCSB_MEMCACHED_CONFIG_H
 
 #include <string>
+#include <list>
 #include "yaml-cpp/yaml.h"
+#include "measurement_config.h"
+#include "sweep.h"
 
 using std::string;
+using std::list;
 
 struct MemcachedConfig {
 	struct {
@@ -29,12 +33,15 @@ struct MemcachedConfig {
 		double zipfian_constant;
 		long scan_length;
 	} workload;
-	struct {
-		string latency_file;
-	} measurement;
+	MeasurementConfig measurement;
+	SweepConfig sweep;
 	struct {
 		string addr;
 		int port;
+		/* poll "stats" on a separate connection every epoch, empty lists for the default fields */
+		bool sample_server_stats;
+		list<string> stat_counter_list;
+		list<string> stat_gauge_list;
 	} memcached;
 
 	static MemcachedConfig parse_yaml(YAML::Node &root);
@@ -64,12 +71,21 @@ MemcachedConfig MemcachedConfig::parse_yaml(YAML::Node &root) {
 	config.workload.zipfian_constant = workload["zipfian_constant"].as<double>();
 	config.workload.scan_length = workload["scan_length"].as<long>();
 
-	YAML::Node measurement = root["measurement"];
-	config.measurement.latency_file = measurement["latency_file"].as<string>();
+	config.measurement = MeasurementConfig::parse_yaml(root);
+	config.sweep = SweepConfig::parse_yaml(root);
 
 	YAML::Node memcached = root["memcached"];
 	config.memcached.addr = memcached["addr"].as<string>();
 	config.memcached.port = memcached["port"].as<int>();
+	config.memcached.sample_server_stats = false;
+	if (memcached["sample_server_stats"])
+		config.memcached.sample_server_stats = memcached["sample_server_stats"].as<bool>();
+	YAML::Node stat_counter_list = memcached["stat_counter_list"];
+	for (YAML::iterator iter = stat_counter_list.begin(); iter != stat_counter_list.end(); ++iter)
+		config.memcached.stat_counter_list.push_back((*iter).as<string>());
+	YAML::Node stat_gauge_list = memcached["stat_gauge_list"];
+	for (YAML::iterator iter = stat_gauge_list.begin(); iter != stat_gauge_list.end(); ++iter)
+		config.memcached.stat_gauge_list.push_back((*iter).as<string>());
 
 	return config;
 }
@@ -112,11 +112,25 @@ void RedisClient::set_last_reply(redisReply *reply) {
 	this->last_reply = reply;
 }
 
+const std::vector<std::string> RedisFactory::stat_counter_default_list = {
+	"total_commands_processed", "keyspace_hits", "keyspace_misses", "evicted_keys", "expired_keys",
+	"total_net_input_bytes", "total_net_output_bytes",
+};
+const std::vector<std::string> RedisFactory::stat_gauge_default_list = {
+	"used_memory", "used_memory_rss", "used_memory_peak", "mem_fragmentation_ratio", "maxmemory",
+};
+
 RedisFactory::RedisFactory(const char *redis_addr, int redis_port, int batch_size)
-: redis_addr(redis_addr), redis_port(redis_port), client_id(0), batch_size(batch_size) {
+: redis_addr(redis_addr), redis_port(redis_port), client_id(0), batch_size(batch_size),
+  server_stats_enabled(false), stat_context(nullptr) {
 	;
 }
 
+RedisFactory::~RedisFactory() {
+	if (this->stat_context != nullptr)
+		redisFree(this->stat_context);
+}
+
 RedisClient *RedisFactory::create_client() {
 	RedisClient *client = new RedisClient(this, this->client_id++);
 	return client;
@@ -127,3 +141,72 @@ void RedisFactory::destroy_client(Client *client) {
 	redis_client->close();
 	delete redis_client;
 }
+
+void RedisFactory::enable_server_stats(const std::list<std::string> &counter_list, const std::list<std::string> &gauge_list) {
+	/* empty lists keep the defaults */
+	this->server_stats_enabled = true;
+	if (counter_list.empty())
+		this->stat_counter_list = RedisFactory::stat_counter_default_list;
+	else
+		this->stat_counter_list.assign(counter_list.begin(), counter_list.end());
+	if (gauge_list.empty())
+		this->stat_gauge_list = RedisFactory::stat_gauge_default_list;
+	else
+		this->stat_gauge_list.assign(gauge_list.begin(), gauge_list.end());
+}
+
+int RedisFactory::read_info(const char *section, std::map<std::string, double> *info_map) {
+	if (this->stat_context == nullptr) {
+		this->stat_context = redisConnect(this->redis_addr, this->redis_port);
+		if (this->stat_context == nullptr || this->stat_context->err) {
+			fprintf(stderr, "RedisFactory: stats connection error %s, server stats disabled\n",
+			        this->stat_context ? this->stat_context->errstr : "cannot allocate redis context");
+			if (this->stat_context != nullptr)
+				redisFree(this->stat_context);
+			this->stat_context = nullptr;
+			this->server_stats_enabled = false;
+			return -1;
+		}
+	}
+	redisReply *reply = (redisReply *) redisCommand(this->stat_context, "INFO %s", section);
+	if (reply == nullptr) {
+		fprintf(stderr, "RedisFactory: INFO error: %s, server stats disabled\n", this->stat_context->errstr);
+		this->server_stats_enabled = false;
+		return -1;
+	}
+	if (reply->type == REDIS_REPLY_STRING) {
+		/* "field:value" lines, sections start with '#' */
+		const char *line = reply->str;
+		while (line != nullptr && *line != '\0') {
+			const char *colon = strchr(line, ':');
+			const char *end = strchr(line, '\n');
+			if (line[0] != '#' && colon != nullptr && (end == nullptr || colon < end))
+				(*info_map)[std::string(line, (size_t) (colon - line))] = strtod(colon + 1, nullptr);
+			line = end == nullptr ? nullptr : end + 1;
+		}
+	}
+	freeReplyObject(reply);
+	return 0;
+}
+
+void RedisFactory::sample_stats(std::vector<BackendStat> *stat_arr) {
+	if (!this->server_stats_enabled)
+		return;
+	std::map<std::string, double> info_map;
+	if (this->read_info("memory", &info_map) != 0 || this->read_info("stats", &info_map) != 0)
+		return;
+	for (const std::string &name : this->stat_counter_list) {
+		auto info_it = info_map.find(name);
+		if (info_it != info_map.end())
+			stat_arr->push_back({name, info_it->second, true});
+	}
+	for (const std::string &name : this->stat_gauge_list) {
+		auto info_it = info_map.find(name);
+		if (info_it != info_map.end())
+			stat_arr->push_back({name, info_it->second, false});
+	}
+}
+
+bool RedisFactory::stats_in_epoch_annotation() {
+	return this->server_stats_enabled;
+}
@@ -2,6 +2,10 @@
 #define YCSB_REDIS_CLIENT_H
 
 #include <cstring>
+#include <list>
+#include <map>
+#include <string>
+#include <vector>
 #include "client.h"
 #include <hiredis/hiredis.h>
 
@@ -32,10 +36,28 @@ struct RedisFactory : public ClientFactory {
 	const int redis_port;
 	const int batch_size;
 	std::atomic<int> client_id;
+	/*
+	 * INFO memory and INFO stats polled by the monitor on a connection of its
+	 * own, opened on first use so the measured clients never share it
+	 */
+	bool server_stats_enabled;
+	redisContext *stat_context;
+	std::vector<std::string> stat_counter_list;
+	std::vector<std::string> stat_gauge_list;
+
+	static const std::vector<std::string> stat_counter_default_list;
+	static const std::vector<std::string> stat_gauge_default_list;
 
 	RedisFactory(const char *redis_addr, int redis_port, int batch_size);
+	~RedisFactory();
 	RedisClient *create_client() override;
 	void destroy_client(Client *client) override;
+	void enable_server_stats(const std::list<std::string> &counter_list, const std::list<std::string> &gauge_list);
+	bool stats_in_epoch_annotation() override;
+	void sample_stats(std::vector<BackendStat> *stat_arr) override;
+
+private:
+	int read_info(const char *section, std::map<std::string, double> *info_map);
 };
 
 #endif //YCSB_REDIS_CLIENT_H
@@ -2,9 +2,13 @@
 #define YCSB_REDIS_CONFIG_H
 
 #include <string>
+#include <list>
 #include "yaml-cpp/yaml.h"
+#include "measurement_config.h"
+#include "sweep.h"
 
 using std::string;
+using std::list;
 
 struct RedisConfig {
 	struct {
@@ -29,13 +33,16 @@ struct RedisConfig {
 		double zipfian_constant;
 		long scan_length;
 	} workload;
-	struct {
-		string latency_file;
-	} measurement;
+	MeasurementConfig measurement;
+	SweepConfig sweep;
 	struct {
 		string addr;
 		int port;
 		int batch_size;
+		/* poll INFO on a separate connection every epoch, empty lists for the default fields */
+		bool sample_server_stats;
+		list<string> stat_counter_list;
+		list<string> stat_gauge_list;
 	} redis;
 
 	static RedisConfig parse_yaml(YAML::Node &root);
@@ -65,13 +72,22 @@ RedisConfig RedisConfig::parse_yaml(YAML::Node &root) {
 	config.workload.zipfian_constant = workload["zipfian_constant"].as<double>();
 	config.workload.scan_length = workload["scan_length"].as<long>();
 
-	YAML::Node measurement = root["measurement"];
-	config.measurement.latency_file = measurement["latency_file"].as<string>();
+	config.measurement = MeasurementConfig::parse_yaml(root);
+	config.sweep = SweepConfig::parse_yaml(root);
 
 	YAML::Node redis = root["redis"];
 	config.redis.addr = redis["addr"].as<string>();
 	config.redis.port = redis["port"].as<int>();
 	config.redis.batch_size = redis["batch_size"].as<int>();
+	config.redis.sample_server_stats = false;
+	if (redis["sample_server_stats"])
+		config.redis.sample_server_stats = redis["sample_server_stats"].as<bool>();
+	YAML::Node stat_counter_list = redis["stat_counter_list"];
+	for (YAML::iterator iter = stat_counter_list.begin(); iter != stat_counter_list.end(); ++iter)
+		config.redis.stat_counter_list.push_back((*iter).as<string>());
+	YAML::Node stat_gauge_list = redis["stat_gauge_list"];
+	for (YAML::iterator iter = stat_gauge_list.begin(); iter != stat_gauge_list.end(); ++iter)
+		config.redis.stat_gauge_list.push_back((*iter).as<string>());
 
 	return config;
 }
@@ -3,25 +3,97 @@
 #include <atomic>
 
 #include "rocksdb_client.h"
+#include "timer.h"
 #include "rocksdb/cache.h"
 #include "rocksdb/customizable.h"
 #include "rocksdb/env.h"
+#include "rocksdb/iostats_context.h"
 #include "rocksdb/options.h"
+#include "rocksdb/perf_context.h"
+#include "rocksdb/perf_level.h"
 #include "rocksdb/status.h"
 #include "rocksdb/statistics.h"
 #include "rocksdb/utilities/options_util.h"
 
 std::atomic<unsigned int> key_fails = 0;
 
+static const char *rocksdb_perf_metric_name[] = {
+	"get_snapshot_time", "get_from_memtable_time", "seek_on_memtable_time", "get_from_output_files_time",
+	"block_cache_hit_count", "block_read_count", "block_read_time", "block_checksum_time", "block_decompress_time",
+	"bloom_sst_hit_count", "bloom_sst_miss_count", "write_wal_time", "write_memtable_time", "write_delay_time",
+	"io_read_nanos", "io_write_nanos", "io_bytes_read", "io_bytes_written",
+};
+
+RocksDBPerfStats::RocksDBPerfStats() : nr_sample(0) {
+	for (int i = 0; i < NR_ROCKSDB_PERF_METRIC; ++i) {
+		this->metric_arr[i] = 0;
+	}
+}
+
+void RocksDBPerfStats::add(const RocksDBPerfStats &other) {
+	this->nr_sample += other.nr_sample;
+	for (int i = 0; i < NR_ROCKSDB_PERF_METRIC; ++i) {
+		this->metric_arr[i] += other.metric_arr[i];
+	}
+}
+
+void RocksDBPerfStats::print(const char *label) const {
+	printf("%s: %ld sampled ops", label, this->nr_sample);
+	for (int i = 0; i < NR_ROCKSDB_PERF_METRIC; ++i) {
+		printf(", %s %.1lf", rocksdb_perf_metric_name[i], (double) this->metric_arr[i] / (double) this->nr_sample);
+	}
+	printf(" (per op)\n");
+}
+
 RocksDBClient::RocksDBClient(RocksDBFactory *factory, int id)
 	: Client(id, factory) {
 	this->db = factory->db;
+	this->perf_sample_interval = factory->perf_context_sample_interval;
+	this->nr_op_since_perf_sample = 0;
 	}
 
 RocksDBClient::~RocksDBClient() {}
 
+void RocksDBClient::start_perf_sample() {
+	/* perf level and both contexts are thread-local, so only this op is counted */
+	rocksdb::SetPerfLevel(rocksdb::PerfLevel::kEnableTimeExceptForMutex);
+	rocksdb::get_perf_context()->Reset();
+	rocksdb::get_iostats_context()->Reset();
+}
+
+void RocksDBClient::finish_perf_sample(OperationType type) {
+	rocksdb::SetPerfLevel(rocksdb::PerfLevel::kDisable);
+	const rocksdb::PerfContext *perf = rocksdb::get_perf_context();
+	const rocksdb::IOStatsContext *iostats = rocksdb::get_iostats_context();
+	RocksDBPerfStats &stats = this->perf_stats_arr[type];
+	++stats.nr_sample;
+	stats.metric_arr[ROCKSDB_PERF_GET_SNAPSHOT_TIME] += perf->get_snapshot_time;
+	stats.metric_arr[ROCKSDB_PERF_GET_FROM_MEMTABLE_TIME] += perf->get_from_memtable_time;
+	stats.metric_arr[ROCKSDB_PERF_SEEK_ON_MEMTABLE_TIME] += perf->seek_on_memtable_time;
+	stats.metric_arr[ROCKSDB_PERF_GET_FROM_OUTPUT_FILES_TIME] += perf->get_from_output_files_time;
+	stats.metric_arr[ROCKSDB_PERF_BLOCK_CACHE_HIT_COUNT] += perf->block_cache_hit_count;
+	stats.metric_arr[ROCKSDB_PERF_BLOCK_READ_COUNT] += perf->block_read_count;
+	stats.metric_arr[ROCKSDB_PERF_BLOCK_READ_TIME] += perf->block_read_time;
+	stats.metric_arr[ROCKSDB_PERF_BLOCK_CHECKSUM_TIME] += perf->block_checksum_time;
+	stats.metric_arr[ROCKSDB_PERF_BLOCK_DECOMPRESS_TIME] += perf->block_decompress_time;
+	stats.metric_arr[ROCKSDB_PERF_BLOOM_SST_HIT_COUNT] += perf->bloom_sst_hit_count;
+	stats.metric_arr[ROCKSDB_PERF_BLOOM_SST_MISS_COUNT] += perf->bloom_sst_miss_count;
+	stats.metric_arr[ROCKSDB_PERF_WRITE_WAL_TIME] += perf->write_wal_time;
+	stats.metric_arr[ROCKSDB_PERF_WRITE_MEMTABLE_TIME] += perf->write_memtable_time;
+	stats.metric_arr[ROCKSDB_PERF_WRITE_DELAY_TIME] += perf->write_delay_time;
+	stats.metric_arr[ROCKSDB_PERF_IO_READ_NANOS] += iostats->read_nanos;
+	stats.metric_arr[ROCKSDB_PERF_IO_WRITE_NANOS] += iostats->write_nanos;
+	stats.metric_arr[ROCKSDB_PERF_IO_BYTES_READ] += iostats->bytes_read;
+	stats.metric_arr[ROCKSDB_PERF_IO_BYTES_WRITTEN] += iostats->bytes_written;
+}
+
 int RocksDBClient::do_operation(Operation *op) {
 	int ret = 0;
+	bool perf_sample = this->perf_sample_interval > 0 && ++this->nr_op_since_perf_sample >= this->perf_sample_interval;
+	if (perf_sample) {
+		this->nr_op_since_perf_sample = 0;
+		this->start_perf_sample();
+	}
 repeat:
 	switch (op->type) {
 	case UPDATE:
@@ -46,6 +118,8 @@ repeat:
 		std::cout << "Key actually failed: " << op->key_buffer << std::endl;
 		//goto repeat;
 	}
+	if (perf_sample)
+		this->finish_perf_sample(op->type);
 	return ret;
 }
 
@@ -128,10 +202,114 @@ int RocksDBClient::reset() {return 0;}
 
 void RocksDBClient::close() {}
 
+/* tickers, histograms and integer properties sampled for the backend stats file */
+static const std::pair<uint32_t, const char *> sampled_ticker_arr[] = {
+	{rocksdb::BLOCK_CACHE_HIT, "rocksdb.block.cache.hit"},
+	{rocksdb::BLOCK_CACHE_MISS, "rocksdb.block.cache.miss"},
+	{rocksdb::BLOCK_CACHE_DATA_HIT, "rocksdb.block.cache.data.hit"},
+	{rocksdb::BLOCK_CACHE_DATA_MISS, "rocksdb.block.cache.data.miss"},
+	{rocksdb::BLOOM_FILTER_USEFUL, "rocksdb.bloom.filter.useful"},
+	{rocksdb::MEMTABLE_HIT, "rocksdb.memtable.hit"},
+	{rocksdb::MEMTABLE_MISS, "rocksdb.memtable.miss"},
+	{rocksdb::NUMBER_KEYS_READ, "rocksdb.number.keys.read"},
+	{rocksdb::NUMBER_KEYS_WRITTEN, "rocksdb.number.keys.written"},
+	{rocksdb::BYTES_READ, "rocksdb.bytes.read"},
+	{rocksdb::BYTES_WRITTEN, "rocksdb.bytes.written"},
+	{rocksdb::COMPACT_READ_BYTES, "rocksdb.compact.read.bytes"},
+	{rocksdb::COMPACT_WRITE_BYTES, "rocksdb.compact.write.bytes"},
+	{rocksdb::FLUSH_WRITE_BYTES, "rocksdb.flush.write.bytes"},
+	{rocksdb::STALL_MICROS, "rocksdb.stall.micros"},
+	{rocksdb::WAL_FILE_BYTES, "rocksdb.wal.bytes"},
+};
+
+static const std::pair<uint32_t, const char *> sampled_histogram_arr[] = {
+	{rocksdb::DB_GET, "rocksdb.db.get.micros"},
+	{rocksdb::DB_WRITE, "rocksdb.db.write.micros"},
+	{rocksdb::COMPACTION_TIME, "rocksdb.compaction.times.micros"},
+	{rocksdb::FLUSH_TIME, "rocksdb.db.flush.micros"},
+};
+
+static const char *sampled_property_arr[] = {
+	"rocksdb.estimate-pending-compaction-bytes",
+	"rocksdb.cur-size-all-mem-tables",
+	"rocksdb.size-all-mem-tables",
+	"rocksdb.num-immutable-mem-table",
+	"rocksdb.num-running-flushes",
+	"rocksdb.num-running-compactions",
+	"rocksdb.actual-delayed-write-rate",
+	"rocksdb.is-write-stopped",
+	"rocksdb.block-cache-usage",
+	"rocksdb.estimate-live-data-size",
+};
+
+static const char *write_stall_condition_name(rocksdb::WriteStallCondition condition) {
+	switch (condition) {
+	case rocksdb::WriteStallCondition::kDelayed:
+		return "delayed";
+	case rocksdb::WriteStallCondition::kStopped:
+		return "stopped";
+	default:
+		return "normal";
+	}
+}
+
+RocksDBEventListener::RocksDBEventListener()
+	: nr_running_flush(0), nr_running_compaction(0), stall_condition((int) rocksdb::WriteStallCondition::kNormal) {}
+
+void RocksDBEventListener::add_event(const char *name, const std::string &detail) {
+	BackendEvent event{Timer::now_ns(), name, detail};
+	std::lock_guard<std::mutex> lock(this->event_lock);
+	if (this->event_arr.size() >= max_nr_event)
+		this->event_arr.erase(this->event_arr.begin());
+	this->event_arr.push_back(std::move(event));
+}
+
+void RocksDBEventListener::OnFlushBegin(rocksdb::DB *db, const rocksdb::FlushJobInfo &info) {
+	++this->nr_running_flush;
+	this->add_event("flush begin", "cf " + info.cf_name + ", job " + std::to_string(info.job_id) + ", reason "
+	                + rocksdb::GetFlushReasonString(info.flush_reason));
+}
+
+void RocksDBEventListener::OnFlushCompleted(rocksdb::DB *db, const rocksdb::FlushJobInfo &info) {
+	--this->nr_running_flush;
+	this->add_event("flush end", "cf " + info.cf_name + ", job " + std::to_string(info.job_id));
+}
+
+void RocksDBEventListener::OnCompactionBegin(rocksdb::DB *db, const rocksdb::CompactionJobInfo &info) {
+	++this->nr_running_compaction;
+	this->add_event("compaction begin", "cf " + info.cf_name + ", job " + std::to_string(info.job_id) + ", L"
+	                + std::to_string(info.base_input_level) + " -> L" + std::to_string(info.output_level) + ", reason "
+	                + rocksdb::GetCompactionReasonString(info.compaction_reason));
+}
+
+void RocksDBEventListener::OnCompactionCompleted(rocksdb::DB *db, const rocksdb::CompactionJobInfo &info) {
+	--this->nr_running_compaction;
+	char detail[256];
+	snprintf(detail, sizeof(detail), ", L%d -> L%d, read %.2f MB, written %.2f MB, %.3f s", info.base_input_level,
+	         info.output_level, (double) info.stats.total_input_bytes / 1e6, (double) info.stats.total_output_bytes / 1e6,
+	         (double) info.stats.elapsed_micros / 1e6);
+	this->add_event("compaction end", "cf " + info.cf_name + ", job " + std::to_string(info.job_id) + detail);
+}
+
+void RocksDBEventListener::OnStallConditionsChanged(const rocksdb::WriteStallInfo &info) {
+	this->stall_condition = (int) info.condition.cur;
+	this->add_event("write stall", "cf " + info.cf_name + ", " + write_stall_condition_name(info.condition.prev) + " -> "
+	                + write_stall_condition_name(info.condition.cur));
+}
+
+void RocksDBEventListener::drain(std::vector<BackendEvent> *out_arr) {
+	std::lock_guard<std::mutex> lock(this->event_lock);
+	for (BackendEvent &event : this->event_arr)
+		out_arr->push_back(std::move(event));
+	this->event_arr.clear();
+}
+
 RocksDBFactory::RocksDBFactory(std::string data_dir, std::string options_file,
-							   long long cache_size, bool print_stats): client_id(0) {
+							   long long cache_size, bool print_stats, long perf_context_sample_interval,
+							   bool collect_statistics): client_id(0) {
 	this->data_dir = data_dir;
 	this->print_stats = print_stats;
+	this->perf_context_sample_interval = perf_context_sample_interval;
 
 	rocksdb::Status status;
 	rocksdb::Options options;
@@ -145,6 +323,7 @@ RocksDBFactory::RocksDBFactory(std::string data_dir, std::string options_file,
 		throw std::invalid_argument("you really want to specify an options file!");
 	}
 	this->_cache = rocksdb::NewLRUCache(cache_size);
+	this->_event_listener = std::make_shared<RocksDBEventListener>();
 
     // make config_options
     rocksdb::ConfigOptions config_options;
@@ -155,18 +334,20 @@ RocksDBFactory::RocksDBFactory(std::string data_dir, std::string options_file,
 			fprintf(stderr, "RocksDBFactory: failed to load options from file, ret: %s\n", status.ToString().c_str());
 			throw std::invalid_argument("failed to load options from file");
 		}
-		if (this->print_stats) {
+		if (this->print_stats || collect_statistics) {
 			db_options.statistics = rocksdb::CreateDBStatistics();
 			db_options.statistics->set_stats_level(rocksdb::StatsLevel::kAll);
 		}
 		auto existing_table_options = cf_descs[0].options.table_factory->GetOptions<rocksdb::BlockBasedTableOptions>();
 		existing_table_options->block_cache = this->_cache;
+		db_options.listeners.push_back(this->_event_listener);
 		status = rocksdb::DB::Open(db_options, data_dir, cf_descs, &cf_handles, &this->db);
 	} else {
 		auto existing_table_options = options.table_factory->GetOptions<rocksdb::BlockBasedTableOptions>();
 		existing_table_options->block_cache = this->_cache;
 		options.create_if_missing = true;
-		if (this->print_stats) {
+		options.listeners.push_back(this->_event_listener);
+		if (this->print_stats || collect_statistics) {
 			options.statistics = rocksdb::CreateDBStatistics();
 		}
 		status = rocksdb::DB::Open(options, data_dir, &this->db);
@@ -176,6 +357,7 @@ RocksDBFactory::RocksDBFactory(std::string data_dir, std::string options_file,
 		throw std::invalid_argument("failed to open db");
 	}
 	fprintf(stderr, "RocksDBFactory: DB has '%d' levels\n" , this->db->NumberLevels());
+	this->_statistics = this->db->GetOptions().statistics;
 }
 
 RocksDBFactory::~RocksDBFactory() {
@@ -214,5 +396,92 @@ RocksDBClient * RocksDBFactory::create_client() {
 
 void RocksDBFactory::destroy_client(Client *client) {
 	RocksDBClient *rocksdb_client = (RocksDBClient *)client;
+	if (rocksdb_client->perf_sample_interval > 0) {
+		std::lock_guard<std::mutex> guard(this->perf_stats_lock);
+		RocksDBPerfStats client_stats;
+		for (int i = 0; i < NR_OP_TYPE; ++i) {
+			this->perf_stats_arr[i].add(rocksdb_client->perf_stats_arr[i]);
+			client_stats.add(rocksdb_client->perf_stats_arr[i]);
+		}
+		this->client_perf_stats_list.push_back(std::make_pair(rocksdb_client->id, client_stats));
+	}
 	delete rocksdb_client;
 }
+
+void RocksDBFactory::print_perf_context(const char *task) {
+	/* clients are destroyed at the end of each phase, report_phase prints right after that */
+	std::lock_guard<std::mutex> guard(this->perf_stats_lock);
+	char label[256];
+	for (int i = 0; i < NR_OP_TYPE; ++i) {
+		if (this->perf_stats_arr[i].nr_sample == 0)
+			continue;
+		snprintf(label, sizeof(label), "%s RocksDB perf context (%s)", task, operation_type_name[i]);
+		this->perf_stats_arr[i].print(label);
+		this->perf_stats_arr[i] = RocksDBPerfStats();
+	}
+	for (auto &client_it : this->client_perf_stats_list) {
+		if (client_it.second.nr_sample == 0)
+			continue;
+		snprintf(label, sizeof(label), "%s RocksDB perf context (client %d)", task, client_it.first);
+		client_it.second.print(label);
+	}
+	this->client_perf_stats_list.clear();
+}
+
+void RocksDBFactory::report_phase(const char *phase_label) {
+	if (this->perf_context_sample_interval > 0)
+		this->print_perf_context(phase_label);
+}
+
+void RocksDBFactory::drain_events(std::vector<BackendEvent> *event_arr) {
+	this->_event_listener->drain(event_arr);
+}
+
+std::string RocksDBFactory::get_epoch_annotation() {
+	std::string annotation = std::to_string(this->_event_listener->nr_running_flush.load()) + " flush running, "
+	                         + std::to_string(this->_event_listener->nr_running_compaction.load()) + " compaction running";
+	auto stall_condition = (rocksdb::WriteStallCondition) this->_event_listener->stall_condition.load();
+	if (stall_condition != rocksdb::WriteStallCondition::kNormal)
+		annotation += std::string(", write stall ") + write_stall_condition_name(stall_condition);
+	std::string nr_l0_file;
+	if (this->db->GetProperty("rocksdb.num-files-at-level0", &nr_l0_file))
+		annotation += ", L0 files " + nr_l0_file;
+	return annotation;
+}
+
+void RocksDBFactory::sample_stats(std::vector<BackendStat> *stat_arr) {
+	/* tickers need statistics, enabled by print_stats or a backend stats file */
+	if (this->_statistics != nullptr) {
+		for (auto &ticker : sampled_ticker_arr)
+			stat_arr->push_back({ticker.second, (double) this->_statistics->getTickerCount(ticker.first), true});
+		/* only count and sum are cumulative, so the interval average is sum / count of the deltas */
+		rocksdb::HistogramData data;
+		for (auto &histogram : sampled_histogram_arr) {
+			this->_statistics->histogramData(histogram.first, &data);
+			stat_arr->push_back({std::string(histogram.second) + ".count", (double) data.count, true});
+			stat_arr->push_back({std::string(histogram.second) + ".sum", (double) data.sum, true});
+		}
+	}
+	uint64_t value;
+	for (const char *property : sampled_property_arr) {
+		if (this->db->GetIntProperty(property, &value))
+			stat_arr->push_back({property, (double) value, false});
+	}
+	std::string nr_file;
+	for (int level = 0; level < this->db->NumberLevels(); ++level) {
+		std::string property = "rocksdb.num-files-at-level" + std::to_string(level);
+		if (this->db->GetProperty(property, &nr_file))
+			stat_arr->push_back({property, std::stod(nr_file), false});
+	}
+}
+
+void RocksDBFactory::get_file_groups(std::map<std::string, std::string> *file_group_map) {
+	/* live ssts by level, names come with a leading '/' */
+	std::vector<rocksdb::LiveFileMetaData> file_arr;
+	this->db->GetLiveFilesMetaData(&file_arr);
+	for (const rocksdb::LiveFileMetaData &file : file_arr) {
+		size_t slash = file.name.rfind('/');
+		std::string file_name = slash == std::string::npos ? file.name : file.name.substr(slash + 1);
+		(*file_group_map)[file_name] = "L" + std::to_string(file.level);
+	}
+}
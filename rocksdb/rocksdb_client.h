@@ -1,13 +1,80 @@
 #ifndef YCSB_WT_CLIENT_H
 #define YCSB_WT_CLIENT_H
 
+#include <atomic>
+#include <mutex>
+#include <vector>
 #include "client.h"
 #include "rocksdb/db.h"
+#include "rocksdb/listener.h"
 
 struct RocksDBFactory;
 
+/* PerfContext and IOStatsContext counters kept for sampled ops, *_time and *_nanos are ns */
+enum RocksDBPerfMetric {
+	ROCKSDB_PERF_GET_SNAPSHOT_TIME = 0,
+	ROCKSDB_PERF_GET_FROM_MEMTABLE_TIME,
+	ROCKSDB_PERF_SEEK_ON_MEMTABLE_TIME,
+	ROCKSDB_PERF_GET_FROM_OUTPUT_FILES_TIME,
+	ROCKSDB_PERF_BLOCK_CACHE_HIT_COUNT,
+	ROCKSDB_PERF_BLOCK_READ_COUNT,
+	ROCKSDB_PERF_BLOCK_READ_TIME,
+	ROCKSDB_PERF_BLOCK_CHECKSUM_TIME,
+	ROCKSDB_PERF_BLOCK_DECOMPRESS_TIME,
+	ROCKSDB_PERF_BLOOM_SST_HIT_COUNT,
+	ROCKSDB_PERF_BLOOM_SST_MISS_COUNT,
+	ROCKSDB_PERF_WRITE_WAL_TIME,
+	ROCKSDB_PERF_WRITE_MEMTABLE_TIME,
+	ROCKSDB_PERF_WRITE_DELAY_TIME,
+	ROCKSDB_PERF_IO_READ_NANOS,
+	ROCKSDB_PERF_IO_WRITE_NANOS,
+	ROCKSDB_PERF_IO_BYTES_READ,
+	ROCKSDB_PERF_IO_BYTES_WRITTEN,
+	NR_ROCKSDB_PERF_METRIC,
+};
+
+struct RocksDBPerfStats {
+	long nr_sample;
+	uint64_t metric_arr[NR_ROCKSDB_PERF_METRIC];
+
+	RocksDBPerfStats();
+	void add(const RocksDBPerfStats &other);
+	void print(const char *label) const;
+};
+
+/*
+ * collects flush, compaction and write stall events for the monitor
+ *
+ * callbacks run on rocksdb's background threads. events pile up between phases
+ * when nobody drains them, so only the latest max_nr_event are kept.
+ */
+struct RocksDBEventListener : public rocksdb::EventListener {
+	static const size_t max_nr_event = 4096;
+
+	std::mutex event_lock;
+	std::vector<BackendEvent> event_arr;
+	std::atomic<int> nr_running_flush;
+	std::atomic<int> nr_running_compaction;
+	std::atomic<int> stall_condition;
+
+	RocksDBEventListener();
+	void OnFlushBegin(rocksdb::DB *db, const rocksdb::FlushJobInfo &info) override;
+	void OnFlushCompleted(rocksdb::DB *db, const rocksdb::FlushJobInfo &info) override;
+	void OnCompactionBegin(rocksdb::DB *db, const rocksdb::CompactionJobInfo &info) override;
+	void OnCompactionCompleted(rocksdb::DB *db, const rocksdb::CompactionJobInfo &info) override;
+	void OnStallConditionsChanged(const rocksdb::WriteStallInfo &info) override;
+	void drain(std::vector<BackendEvent> *out_arr);
+
+private:
+	void add_event(const char *name, const std::string &detail);
+};
+
 struct RocksDBClient : public Client {
 	rocksdb::DB *db;
+	/* PerfContext sampling, every perf_sample_interval-th op, 0 to disable */
+	long perf_sample_interval;
+	long nr_op_since_perf_sample;
+	RocksDBPerfStats perf_stats_arr[NR_OP_TYPE];
 
 	RocksDBClient(RocksDBFactory *factory, int id);
 	~RocksDBClient();
@@ -21,6 +88,8 @@ private:
 	int do_read(char *key_buffer, char **value);
 	int do_scan(char *key_buffer, long scan_length);
 	int do_read_modify_write(char *key_buffer, char *value_buffer);
+	void start_perf_sample();
+	void finish_perf_sample(OperationType type);
 };
 
 struct RocksDBFactory : public ClientFactory {
@@ -28,17 +97,32 @@ struct RocksDBFactory : public ClientFactory {
 	std::atomic<int> client_id;
 	std::string data_dir;
 	bool print_stats;
+	long perf_context_sample_interval;
+
+	/* perf context samples of the clients destroyed since the last print_perf_context */
+	std::mutex perf_stats_lock;
+	RocksDBPerfStats perf_stats_arr[NR_OP_TYPE];
+	std::vector<std::pair<int, RocksDBPerfStats>> client_perf_stats_list;
 
 	// Private fields
 	std::shared_ptr<rocksdb::Cache> _cache;
+	std::shared_ptr<RocksDBEventListener> _event_listener;
+	std::shared_ptr<rocksdb::Statistics> _statistics;
 
 	RocksDBFactory(std::string data_dir, std::string options_file,
-				   long long cache_size, bool print_stats);
+				   long long cache_size, bool print_stats, long perf_context_sample_interval = 0,
+				   bool collect_statistics = false);
 	~RocksDBFactory();
 	RocksDBClient *create_client() override;
 	void destroy_client(Client *client) override;
 	void do_print_stats();
 	void reset_stats();
+	void print_perf_context(const char *task);
+	void report_phase(const char *phase_label) override;
+	void drain_events(std::vector<BackendEvent> *event_arr) override;
+	std::string get_epoch_annotation() override;
+	void sample_stats(std::vector<BackendStat> *stat_arr) override;
+	void get_file_groups(std::map<std::string, std::string> *file_group_map) override;
 };
 
 #endif //YCSB_WT_CLIENT_H
@@ -4,6 +4,8 @@
 #include <string>
 #include <list>
 #include "yaml-cpp/yaml.h"
+#include "measurement_config.h"
+#include "sweep.h"
 
 using std::string;
 using std::list;
@@ -38,7 +40,11 @@ struct RocksDBConfig {
 		string options_file;
 		long long cache_size;
 		bool print_stats;
+		/* sample PerfContext/IOStatsContext every Nth op per client, 0 to disable */
+		long perf_context_sample_interval;
 	} rocksdb;
+	MeasurementConfig measurement;
+	SweepConfig sweep;
 
 	static RocksDBConfig parse_yaml(YAML::Node &root);
 };
@@ -79,6 +85,15 @@ RocksDBConfig RocksDBConfig::parse_yaml(YAML::Node &root) {
 		config.rocksdb.options_file = rocksdb["options_file"].as<string>();
 	config.rocksdb.cache_size = rocksdb["cache_size"].as<long long>();
 	config.rocksdb.print_stats = rocksdb["print_stats"].as<bool>();
+	config.rocksdb.perf_context_sample_interval = 0;
+	if (rocksdb["perf_context_sample_interval"])
+		config.rocksdb.perf_context_sample_interval = rocksdb["perf_context_sample_interval"].as<long>();
+
+	config.measurement = MeasurementConfig::parse_yaml(root);
+	config.sweep = SweepConfig::parse_yaml(root);
+	/* sample i/o of the device the database lives on unless told otherwise */
+	if (config.measurement.data_dir.empty())
+		config.measurement.data_dir = config.rocksdb.data_dir;
 
 	return config;
 }
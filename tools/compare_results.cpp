@@ -0,0 +1,166 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cerrno>
+#include <fstream>
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "result.h"
+
+typedef std::map<std::string, std::vector<PhaseResult>> ResultMap;
+
+static int load_results(const char *path, ResultMap *result_map) {
+	std::ifstream in(path);
+	if (!in.is_open()) {
+		fprintf(stderr, "compare_results: failed to open %s\n", path);
+		return -ENOENT;
+	}
+	PhaseResult result;
+	while (PhaseResult::load(in, &result))
+		(*result_map)[result.task].push_back(result);
+	return 0;
+}
+
+/* welch's t-test on the means of two sets of repetitions */
+static void compare_metric(const char *name, const std::vector<double> &baseline_arr, const std::vector<double> &candidate_arr) {
+	SampleStats baseline(baseline_arr), candidate(candidate_arr);
+	double change = baseline.mean != 0 ? 100 * (candidate.mean - baseline.mean) / baseline.mean : 0;
+	printf("  %s: baseline %.2lf, candidate %.2lf, change %+.2lf%%", name, baseline.mean, candidate.mean, change);
+	if (baseline.count < 2 || candidate.count < 2) {
+		printf(", not tested (needs at least 2 repetitions per side)\n");
+		return;
+	}
+	double baseline_var = baseline.stddev * baseline.stddev / (double) baseline.count;
+	double candidate_var = candidate.stddev * candidate.stddev / (double) candidate.count;
+	if (baseline_var + candidate_var == 0) {
+		printf(", no variance, %s\n", change != 0 ? "significant" : "not significant");
+		return;
+	}
+	double t = (candidate.mean - baseline.mean) / std::sqrt(baseline_var + candidate_var);
+	double df = (baseline_var + candidate_var) * (baseline_var + candidate_var)
+	            / (baseline_var * baseline_var / (double) (baseline.count - 1) + candidate_var * candidate_var / (double) (candidate.count - 1));
+	double critical = student_t_critical_95(df);
+	printf(", t %.3lf (df %.1lf, critical %.3lf), %s at 95%%\n", t, df, critical,
+	       std::fabs(t) > critical ? "significant" : "not significant");
+}
+
+/*
+ * how far apart the pooled latency distributions are, as an effect size only
+ *
+ * per-op latencies are autocorrelated and number in the millions, so a
+ * kolmogorov-smirnov test on them rejects on any shift. significance comes
+ * from the per-repetition metrics above, this only says how large a change is.
+ */
+static void compare_distribution(const char *name, size_t type, const std::vector<PhaseResult> &baseline_arr,
+                                 const std::vector<PhaseResult> &candidate_arr) {
+	LatencyHistogram baseline(baseline_arr[0].latency_hist[type].precision_bits);
+	LatencyHistogram candidate(baseline.precision_bits);
+	try {
+		for (const PhaseResult &result : baseline_arr)
+			baseline.merge(result.latency_hist[type]);
+		for (const PhaseResult &result : candidate_arr)
+			candidate.merge(result.latency_hist[type]);
+	} catch (const std::invalid_argument &) {
+		printf("  %s latency distribution: incompatible result files, histograms use different precision_bits\n", name);
+		return;
+	}
+	double n = (double) baseline.get_count(), m = (double) candidate.get_count();
+	long baseline_sum = 0, candidate_sum = 0;
+	double max_distance = 0;
+	size_t max_distance_bucket = 0;
+	for (size_t i = 0; i < baseline.counts.size(); ++i) {
+		baseline_sum += baseline.counts[i];
+		candidate_sum += candidate.counts[i];
+		double distance = std::fabs((double) baseline_sum / n - (double) candidate_sum / m);
+		if (distance > max_distance) {
+			max_distance = distance;
+			max_distance_bucket = i;
+		}
+	}
+	printf("  %s latency distribution: largest cdf gap %.4lf at %ld ns, average latency change %+.2lf%% (effect size, not a test)\n",
+	       name, max_distance, baseline.bucket_upper_bound((long) max_distance_bucket),
+	       baseline.get_average() != 0 ? 100 * (candidate.get_average() - baseline.get_average()) / baseline.get_average() : 0);
+}
+
+static void compare_task(const std::string &task, const std::vector<PhaseResult> &baseline_arr,
+                         const std::vector<PhaseResult> &candidate_arr) {
+	printf("%s: baseline %zu repetitions, candidate %zu repetitions\n", task.c_str(), baseline_arr.size(), candidate_arr.size());
+	std::vector<double> baseline_value_arr, candidate_value_arr;
+	for (const PhaseResult &result : baseline_arr)
+		baseline_value_arr.push_back(result.get_total_throughput());
+	for (const PhaseResult &result : candidate_arr)
+		candidate_value_arr.push_back(result.get_total_throughput());
+	compare_metric("total throughput (ops/sec)", baseline_value_arr, candidate_value_arr);
+
+	const double percentile_arr[] = {0.5, 0.99, 0.999};
+	const char *percentile_name_arr[] = {"p50", "p99", "p99.9"};
+	for (size_t i = 0; i < NR_OP_TYPE; ++i) {
+		long baseline_count = 0, candidate_count = 0;
+		for (const PhaseResult &result : baseline_arr)
+			baseline_count += result.latency_hist[i].get_count();
+		for (const PhaseResult &result : candidate_arr)
+			candidate_count += result.latency_hist[i].get_count();
+		if (baseline_count == 0 || candidate_count == 0)
+			continue;
+
+		std::string metric_name = std::string(operation_type_name[i]) + " throughput (ops/sec)";
+		baseline_value_arr.clear();
+		candidate_value_arr.clear();
+		for (const PhaseResult &result : baseline_arr)
+			baseline_value_arr.push_back(result.throughput_arr[i]);
+		for (const PhaseResult &result : candidate_arr)
+			candidate_value_arr.push_back(result.throughput_arr[i]);
+		compare_metric(metric_name.c_str(), baseline_value_arr, candidate_value_arr);
+
+		/* one value per repetition, so the test sees as many samples as there were independent runs */
+		metric_name = std::string(operation_type_name[i]) + " average latency (ns)";
+		baseline_value_arr.clear();
+		candidate_value_arr.clear();
+		for (const PhaseResult &result : baseline_arr)
+			baseline_value_arr.push_back(result.latency_hist[i].get_average());
+		for (const PhaseResult &result : candidate_arr)
+			candidate_value_arr.push_back(result.latency_hist[i].get_average());
+		compare_metric(metric_name.c_str(), baseline_value_arr, candidate_value_arr);
+		for (size_t j = 0; j < 3; ++j) {
+			metric_name = std::string(operation_type_name[i]) + " " + percentile_name_arr[j] + " latency (ns)";
+			baseline_value_arr.clear();
+			candidate_value_arr.clear();
+			for (const PhaseResult &result : baseline_arr)
+				baseline_value_arr.push_back(result.latency_hist[i].get_percentile(percentile_arr[j]));
+			for (const PhaseResult &result : candidate_arr)
+				candidate_value_arr.push_back(result.latency_hist[i].get_percentile(percentile_arr[j]));
+			compare_metric(metric_name.c_str(), baseline_value_arr, candidate_value_arr);
+		}
+		compare_distribution(operation_type_name[i], i, baseline_arr, candidate_arr);
+	}
+}
+
+int main(int argc, char *argv[]) {
+	if (argc != 3) {
+		printf("Usage: %s <baseline result file> <candidate result file>\n", argv[0]);
+		return -EINVAL;
+	}
+	ResultMap baseline_map, candidate_map;
+	int ret = load_results(argv[1], &baseline_map);
+	if (ret == 0)
+		ret = load_results(argv[2], &candidate_map);
+	if (ret != 0)
+		return ret;
+
+	/* phases are matched by task name, e.g. "Zipfian" or "Uniform (Warm-Up)" */
+	bool has_common_task = false;
+	for (auto &baseline_it : baseline_map) {
+		auto candidate_it = candidate_map.find(baseline_it.first);
+		if (candidate_it == candidate_map.end())
+			continue;
+		has_common_task = true;
+		compare_task(baseline_it.first, baseline_it.second, candidate_it->second);
+	}
+	if (!has_common_task) {
+		fprintf(stderr, "compare_results: the files share no task\n");
+		return -EINVAL;
+	}
+	return 0;
+}
@@ -0,0 +1,99 @@
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <cerrno>
+#include <map>
+#include <vector>
+#include "latency_log.h"
+#include "histogram.h"
+#include "workload.h"
+
+/* calls fn(timestamp, client_id, op_type, latency) for every record of the log */
+template<typename F>
+static int for_each_record(FILE *file, F fn) {
+	LatencyLogFileHeader file_header;
+	if (fread(&file_header, sizeof(file_header), 1, file) != 1 || file_header.magic != LATENCY_LOG_MAGIC
+	    || file_header.record_size != sizeof(LatencyLogRecord)) {
+		fprintf(stderr, "decode_latency_log: not a latency log or unsupported version\n");
+		return -EINVAL;
+	}
+	LatencyLogChunkHeader chunk_header;
+	std::vector<LatencyLogRecord> record_arr;
+	while (fread(&chunk_header, sizeof(chunk_header), 1, file) == 1) {
+		record_arr.resize(chunk_header.nr_record);
+		if (fread(record_arr.data(), sizeof(LatencyLogRecord), chunk_header.nr_record, file) != chunk_header.nr_record) {
+			fprintf(stderr, "decode_latency_log: truncated chunk, stopping\n");
+			return -EIO;
+		}
+		uint64_t timestamp = chunk_header.base_timestamp;
+		for (const LatencyLogRecord &record : record_arr) {
+			timestamp += record.timestamp_delta;
+			long latency = record.latency;
+			if (record.flags & LATENCY_LOG_FLAG_LATENCY_US)
+				latency *= 1000;
+			fn((long) timestamp, (int) record.client_id, (int) record.op_type, latency);
+		}
+	}
+	return 0;
+}
+
+static int print_csv(FILE *file) {
+	/* same columns as the old end-of-run csv, ordered by client chunk rather than time */
+	printf("Timestamp (ns),Client ID,Operation,Latency (ns)\n");
+	return for_each_record(file, [](long timestamp, int client_id, int op_type, long latency) {
+		printf("%ld,%d,%s,%ld\n", timestamp, client_id,
+		       op_type < NR_OP_TYPE ? operation_type_name[op_type] : "UNKNOWN", latency);
+	});
+}
+
+static int print_summary(FILE *file) {
+	std::vector<LatencyHistogram> hist_arr(NR_OP_TYPE);
+	std::map<int, long> client_op_count;
+	long first_timestamp = -1, last_timestamp = 0;
+	int ret = for_each_record(file, [&](long timestamp, int client_id, int op_type, long latency) {
+		if (op_type >= NR_OP_TYPE)
+			return;
+		hist_arr[(unsigned long) op_type].record(latency);
+		++client_op_count[client_id];
+		if (first_timestamp < 0 || timestamp < first_timestamp)
+			first_timestamp = timestamp;
+		last_timestamp = std::max(last_timestamp, timestamp);
+	});
+	if (ret != 0)
+		return ret;
+
+	double duration = (double) (last_timestamp - first_timestamp) / 1e9;
+	printf("duration %.3f s, clients %zu\n", duration, client_op_count.size());
+	for (int i = 0; i < NR_OP_TYPE; ++i) {
+		const LatencyHistogram &hist = hist_arr[(unsigned long) i];
+		if (hist.get_count() == 0)
+			continue;
+		printf("%s count %ld throughput %.2lf ops/sec average %.2lf ns p50 %.0lf ns p99 %.0lf ns p99.9 %.0lf ns max %ld ns\n",
+		       operation_type_name[i], hist.get_count(), duration > 0 ? (double) hist.get_count() / duration : 0,
+		       hist.get_average(), hist.get_percentile(0.5), hist.get_percentile(0.99), hist.get_percentile(0.999),
+		       hist.get_max());
+	}
+	for (auto &client_it : client_op_count) {
+		printf("client %d ops %ld\n", client_it.first, client_it.second);
+	}
+	return 0;
+}
+
+int main(int argc, char *argv[]) {
+	if (argc != 3 || (strcmp(argv[2], "csv") != 0 && strcmp(argv[2], "summary") != 0)) {
+		printf("Usage: %s <latency file> <csv|summary>\n", argv[0]);
+		return -EINVAL;
+	}
+	FILE *file = fopen(argv[1], "rb");
+	if (file == nullptr) {
+		fprintf(stderr, "decode_latency_log: failed to open %s\n", argv[1]);
+		return -ENOENT;
+	}
+	int ret;
+	if (strcmp(argv[2], "csv") == 0)
+		ret = print_csv(file);
+	else
+		ret = print_summary(file);
+	fclose(file);
+	return ret;
+}
@@ -19,71 +19,100 @@ int main(int argc, char *argv[]) {
 	                          false,
 	                          config.wiredtiger.create_table_config.c_str(),
 	                          config.wiredtiger.print_stats);
+	factory.update_sampled_stats(config.wiredtiger.stat_counter_list, config.wiredtiger.stat_gauge_list);
 	OpProportion op_prop;
 	op_prop.op[READ] = config.workload.operation_proportion.read;
 	op_prop.op[UPDATE] = config.workload.operation_proportion.update;
 	op_prop.op[INSERT] = config.workload.operation_proportion.insert;
 	op_prop.op[SCAN] = config.workload.operation_proportion.scan;
 	op_prop.op[READ_MODIFY_WRITE] = config.workload.operation_proportion.read_modify_write;
-	for (int i = 0; i < 2; ++i) {
-		long nr_op;
-		if (i == 0) {
-			if (config.workload.nr_warmup_op == 0)
-				continue;
-			nr_op = config.workload.nr_warmup_op;
-		} else {
-			nr_op = config.workload.nr_op;
+	SweepPoint base_point;
+	base_point.nr_thread = config.workload.nr_thread;
+	base_point.op_prop = op_prop;
+	base_point.request_distribution = config.workload.request_distribution;
+	base_point.zipfian_constant = config.workload.zipfian_constant;
+	base_point.next_op_interval_ns = config.workload.next_op_interval_ns;
+	/* without a sweep section this is the workload section alone */
+	std::vector<SweepPoint> point_arr = config.sweep.expand(base_point);
+	std::vector<std::vector<PhaseResult>> sweep_result_arr;
+	for (size_t point_index = 0; point_index < point_arr.size(); ++point_index) {
+		const SweepPoint &point = point_arr[point_index];
+		std::string point_suffix;
+		if (config.sweep.enabled()) {
+			point_suffix = " (point " + std::to_string(point_index) + ")";
+			printf("sweep point %zu of %zu: %s\n", point_index + 1, point_arr.size(), point.describe().c_str());
 		}
-		if (config.workload.request_distribution == "uniform") {
-			run_uniform_workload_with_op_measurement(i == 0 ? "Uniform (Warm-Up)" : "Uniform",
-			                                         &factory,
-			                                         config.database.nr_entry,
-			                                         config.database.key_size,
-			                                         config.database.value_size,
-			                                         config.workload.scan_length,
-			                                         config.workload.nr_thread,
-			                                         op_prop,
-			                                         nr_op,
-			                                         config.workload.next_op_interval_ns,
-			                                         nullptr);
-		} else if (config.workload.request_distribution == "zipfian") {
-			run_zipfian_workload_with_op_measurement(i == 0 ? "Zipfian (Warm-Up)" : "Zipfian",
-			                                         &factory,
-			                                         config.database.nr_entry,
-			                                         config.database.key_size,
-			                                         config.database.value_size,
-			                                         config.workload.scan_length,
-			                                         config.workload.nr_thread,
-			                                         op_prop,
-			                                         config.workload.zipfian_constant,
-			                                         nr_op,
-			                                         config.workload.next_op_interval_ns,
-			                                         nullptr);
-		} else if (config.workload.request_distribution == "latest") {
-			run_latest_workload_with_op_measurement(i == 0 ? "Latest (Warm-Up)" : "Latest",
-			                                        &factory,
-			                                        config.database.nr_entry,
-			                                        config.database.key_size,
-			                                        config.database.value_size,
-			                                        config.workload.nr_thread,
-			                                        op_prop.op[READ],
-			                                        config.workload.zipfian_constant,
-			                                        nr_op,
-			                                        config.workload.next_op_interval_ns,
-			                                        nullptr);
-		// }
-		// else if (config.workload.request_distribution == "trace") {
-		// 	run_trace_workload_with_op_measurement(i == 0 ? "Trace (Warm-Up)" : "Trace",
-		// 	                                       &factory,
-		// 	                                       config.database.key_size,
-		// 	                                       config.database.value_size,
-		// 	                                       config.workload.nr_thread,
-		// 	                                       config.workload.trace_file_list,
-		// 	                                       nr_op,
-		// 	                                       config.workload.next_op_interval_ns,
-		// 	                                       nullptr);
-		} else {
-			throw std::invalid_argument("unrecognized workload");
+		for (int i = 0; i < 2; ++i) {
+			long nr_op;
+			if (i == 0) {
+				if (point_index > 0 && !config.sweep.warmup_each_point)
+					continue;
+				if (config.workload.nr_warmup_op == 0)
+					continue;
+				nr_op = config.workload.nr_warmup_op;
+			} else {
+				nr_op = config.workload.nr_op;
+			}
+			MeasurementConfig measurement_config = config.measurement.for_phase(i == 0);
+			std::vector<PhaseResult> result_arr;
+			if (point.request_distribution == "uniform") {
+				result_arr = run_uniform_workload_with_op_measurement((std::string(i == 0 ? "Uniform (Warm-Up)" : "Uniform") + point_suffix).c_str(),
+				                                                      &factory,
+				                                                      config.database.nr_entry,
+				                                                      config.database.key_size,
+				                                                      config.database.value_size,
+				                                                      config.workload.scan_length,
+				                                                      point.nr_thread,
+				                                                      point.op_prop,
+				                                                      nr_op,
+				                                                      0,
+				                                                      point.next_op_interval_ns,
+				                                                      measurement_config);
+			} else if (point.request_distribution == "zipfian") {
+				result_arr = run_zipfian_workload_with_op_measurement((std::string(i == 0 ? "Zipfian (Warm-Up)" : "Zipfian") + point_suffix).c_str(),
+				                                                      &factory,
+				                                                      config.database.nr_entry,
+				                                                      config.database.key_size,
+				                                                      config.database.value_size,
+				                                                      config.workload.scan_length,
+				                                                      point.nr_thread,
+				                                                      point.op_prop,
+				                                                      point.zipfian_constant,
+				                                                      nr_op,
+				                                                      0,
+				                                                      point.next_op_interval_ns,
+				                                                      measurement_config);
+			} else if (point.request_distribution == "latest") {
+				result_arr = run_latest_workload_with_op_measurement((std::string(i == 0 ? "Latest (Warm-Up)" : "Latest") + point_suffix).c_str(),
+				                                                     &factory,
+				                                                     config.database.nr_entry,
+				                                                     config.database.key_size,
+				                                                     config.database.value_size,
+				                                                     point.nr_thread,
+				                                                     point.op_prop.op[READ],
+				                                                     point.zipfian_constant,
+				                                                     nr_op,
+				                                                     0,
+				                                                     point.next_op_interval_ns,
+				                                                     measurement_config);
+			// }
+			// else if (point.request_distribution == "trace") {
+			// 	run_trace_workload_with_op_measurement(i == 0 ? "Trace (Warm-Up)" : "Trace",
+			// 	                                       &factory,
+			// 	                                       config.database.key_size,
+			// 	                                       config.database.value_size,
+			// 	                                       config.workload.nr_thread,
+			// 	                                       config.workload.trace_file_list,
+			// 	                                       nr_op,
+			// 	                                       config.workload.next_op_interval_ns,
+			// 	                                       nullptr);
+			} else {
+				throw std::invalid_argument("unrecognized workload");
+			}
+			if (i == 1)
+				sweep_result_arr.push_back(result_arr);
 		}
 	}
+	if (config.sweep.enabled())
+		report_sweep("WiredTiger", config.sweep, point_arr, sweep_result_arr);
 }
@@ -153,11 +153,28 @@ const char *WiredTigerFactory::conn_default_config = "create,direct_io=[data,che
 	"eviction=(threads_max=6,threads_min=1)";
 const char *WiredTigerFactory::create_table_default_config = "key_format=S,value_format=S,allocation_size=512B,"
 	"internal_page_max=512B,leaf_page_max=512B";
+const std::vector<std::string> WiredTigerFactory::stat_counter_default_list = {
+	"cache: pages requested from the cache",
+	"cache: pages read into cache",
+	"cache: pages written from cache",
+	"cache: modified pages evicted",
+	"cache: unmodified pages evicted",
+	"cache: eviction worker thread evicting pages",
+	"cache: pages evicted by application threads",
+	"transaction: transaction checkpoints",
+	"transaction: transaction checkpoint total time (msecs)",
+};
+const std::vector<std::string> WiredTigerFactory::stat_gauge_default_list = {
+	"cache: bytes currently in the cache",
+	"cache: tracked dirty bytes in the cache",
+	"cache: eviction worker thread active",
+	"transaction: transaction checkpoint currently running",
+};
 
 WiredTigerFactory::WiredTigerFactory(const char *data_dir, const char *table_name, const char *conn_config,
 				     const char *session_config, const char *cursor_config, bool new_table,
 				     const char *create_table_config, bool print_stats)
-	: client_id(0) {
+	: client_id(0), stat_session(nullptr), stat_disabled(false) {
 	if (data_dir == nullptr)
 		data_dir = WiredTigerFactory::default_data_dir;
 	if (table_name == nullptr)
@@ -173,6 +190,7 @@ WiredTigerFactory::WiredTigerFactory(const char *data_dir, const char *table_nam
 	this->cursor_config = cursor_config;
 	this->create_table_config = create_table_config;
 	this->print_stats = print_stats;
+	this->update_sampled_stats(std::list<std::string>(), std::list<std::string>());
 
 	int ret;
 	ret = wiredtiger_open(this->data_dir, nullptr, this->conn_config, &this->conn);
@@ -238,6 +256,8 @@ WiredTigerFactory::~WiredTigerFactory() {
 			throw std::invalid_argument("failed to close stat session");
 		}
 	}
+	if (this->stat_session != nullptr)
+		this->stat_session->close(this->stat_session, nullptr);
 	this->conn->close(this->conn, NULL);
 }
 
@@ -249,6 +269,111 @@ void WiredTigerFactory::update_cursor_config(const char *new_cursor_config) {
 	this->cursor_config = new_cursor_config;
 }
 
+void WiredTigerFactory::update_sampled_stats(const std::list<std::string> &counter_list,
+                                             const std::list<std::string> &gauge_list) {
+	/* empty lists keep the defaults */
+	if (counter_list.empty())
+		this->stat_counter_list = WiredTigerFactory::stat_counter_default_list;
+	else
+		this->stat_counter_list.assign(counter_list.begin(), counter_list.end());
+	if (gauge_list.empty())
+		this->stat_gauge_list = WiredTigerFactory::stat_gauge_default_list;
+	else
+		this->stat_gauge_list.assign(gauge_list.begin(), gauge_list.end());
+	this->stat_set.clear();
+	this->stat_set.insert(this->stat_counter_list.begin(), this->stat_counter_list.end());
+	this->stat_set.insert(this->stat_gauge_list.begin(), this->stat_gauge_list.end());
+}
+
+int WiredTigerFactory::read_stats(std::map<std::string, int64_t> *stat_map) {
+	/* only called from the monitor thread, so the stat session is never shared */
+	if (this->stat_disabled)
+		return -1;
+	int ret;
+	if (this->stat_session == nullptr) {
+		ret = this->conn->open_session(this->conn, nullptr, nullptr, &this->stat_session);
+		if (ret != 0) {
+			fprintf(stderr, "WiredTigerFactory: failed to open stat session, ret: %s\n", wiredtiger_strerror(ret));
+			this->stat_session = nullptr;
+			this->stat_disabled = true;
+			return ret;
+		}
+	}
+	WT_CURSOR *cursor;
+	ret = this->stat_session->open_cursor(this->stat_session, "statistics:", nullptr, "statistics=(fast)", &cursor);
+	if (ret != 0) {
+		/* most likely the connection was opened without statistics=(fast) */
+		fprintf(stderr, "WiredTigerFactory: failed to open stat cursor, ret: %s, sampling disabled\n", wiredtiger_strerror(ret));
+		this->stat_disabled = true;
+		return ret;
+	}
+	const char *desc, *pvalue;
+	int64_t value;
+	while ((ret = cursor->next(cursor)) == 0 &&
+	       (ret = cursor->get_value(cursor, &desc, &pvalue, &value)) == 0) {
+		if (this->stat_set.count(desc) != 0)
+			(*stat_map)[desc] = value;
+	}
+	cursor->close(cursor);
+	return ret == WT_NOTFOUND ? 0 : ret;
+}
+
+std::string WiredTigerFactory::get_epoch_annotation() {
+	std::map<std::string, int64_t> stat_map;
+	if (this->read_stats(&stat_map) != 0)
+		return std::string();
+	std::map<std::string, int64_t> &prev_map = this->prev_epoch_stat_map;
+	std::string annotation;
+	char buffer[256];
+	/* the first epoch only sets the baseline of the counters */
+	if (!prev_map.empty()) {
+		auto requested_it = stat_map.find("cache: pages requested from the cache");
+		auto read_it = stat_map.find("cache: pages read into cache");
+		if (requested_it != stat_map.end() && read_it != stat_map.end()) {
+			int64_t nr_requested = requested_it->second - prev_map[requested_it->first];
+			int64_t nr_read = read_it->second - prev_map[read_it->first];
+			if (nr_requested > 0) {
+				snprintf(buffer, sizeof(buffer), "cache hit ratio %.2f%%",
+				         100 * (1 - (double) nr_read / (double) nr_requested));
+				annotation = buffer;
+			}
+		}
+		for (const std::string &name : this->stat_counter_list) {
+			auto stat_it = stat_map.find(name);
+			if (stat_it == stat_map.end())
+				continue;
+			snprintf(buffer, sizeof(buffer), "%s%s +%ld", annotation.empty() ? "" : ", ", name.c_str(),
+			         (long) (stat_it->second - prev_map[name]));
+			annotation += buffer;
+		}
+	}
+	for (const std::string &name : this->stat_gauge_list) {
+		auto stat_it = stat_map.find(name);
+		if (stat_it == stat_map.end())
+			continue;
+		snprintf(buffer, sizeof(buffer), "%s%s %ld", annotation.empty() ? "" : ", ", name.c_str(), (long) stat_it->second);
+		annotation += buffer;
+	}
+	prev_map = stat_map;
+	return annotation;
+}
+
+void WiredTigerFactory::sample_stats(std::vector<BackendStat> *stat_arr) {
+	std::map<std::string, int64_t> stat_map;
+	if (this->read_stats(&stat_map) != 0)
+		return;
+	for (const std::string &name : this->stat_counter_list) {
+		auto stat_it = stat_map.find(name);
+		if (stat_it != stat_map.end())
+			stat_arr->push_back({name, (double) stat_it->second, true});
+	}
+	for (const std::string &name : this->stat_gauge_list) {
+		auto stat_it = stat_map.find(name);
+		if (stat_it != stat_map.end())
+			stat_arr->push_back({name, (double) stat_it->second, false});
+	}
+}
+
 WiredTigerClient * WiredTigerFactory::create_client() {
 	return new WiredTigerClient(this, this->client_id++, this->session_config, this->cursor_config);
 }
@@ -2,6 +2,11 @@
 #define YCSB_WT_CLIENT_H
 
 #include "client.h"
+#include <list>
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
 #include <wiredtiger.h>
 
 
@@ -41,11 +46,23 @@ struct WiredTigerFactory : public ClientFactory {
 	const char *create_table_config;
 	std::atomic<int> client_id;
 	bool print_stats;
+	/*
+	 * statistics cursor sampled by the monitor on its own session, the workers'
+	 * sessions are never touched. counters are reported as deltas, gauges as read.
+	 */
+	WT_SESSION *stat_session;
+	bool stat_disabled;
+	std::vector<std::string> stat_counter_list;
+	std::vector<std::string> stat_gauge_list;
+	std::set<std::string> stat_set;
+	std::map<std::string, int64_t> prev_epoch_stat_map;
 
 	static const char *default_data_dir;
 	static const char *default_table_name;
 	static const char *conn_default_config;
 	static const char *create_table_default_config;
+	static const std::vector<std::string> stat_counter_default_list;
+	static const std::vector<std::string> stat_gauge_default_list;
 
 	WiredTigerFactory(const char *data_dir, const char *table_name, const char *conn_config,
 			  const char *session_config, const char *cursor_config, bool new_table,
@@ -53,9 +70,15 @@ struct WiredTigerFactory : public ClientFactory {
 	~WiredTigerFactory();
 	void update_session_config(const char *new_session_config);
 	void update_cursor_config(const char *new_cursor_config);
+	void update_sampled_stats(const std::list<std::string> &counter_list, const std::list<std::string> &gauge_list);
 	WiredTigerClient *create_client() override;
 	void destroy_client(Client *client) override;
+	std::string get_epoch_annotation() override;
+	void sample_stats(std::vector<BackendStat> *stat_arr) override;
 	static int print_cursor(WT_CURSOR *cursor);
+
+private:
+	int read_stats(std::map<std::string, int64_t> *stat_map);
 };
 
 #endif //YCSB_WT_CLIENT_H
@@ -4,6 +4,8 @@
 #include <string>
 #include <list>
 #include "yaml-cpp/yaml.h"
+#include "measurement_config.h"
+#include "sweep.h"
 
 using std::string;
 using std::list;
@@ -39,7 +41,12 @@ struct WiredTigerConfig {
 		string cursor_config;
 		string create_table_config;
 		bool print_stats;
+		/* statistics cursor descriptions sampled every epoch, empty for the defaults */
+		list<string> stat_counter_list;
+		list<string> stat_gauge_list;
 	} wiredtiger;
+	MeasurementConfig measurement;
+	SweepConfig sweep;
 
 	static WiredTigerConfig parse_yaml(YAML::Node &root);
 };
@@ -78,6 +85,18 @@ WiredTigerConfig WiredTigerConfig::parse_yaml(YAML::Node &root) {
 	config.wiredtiger.cursor_config = wiredtiger["cursor_config"].as<string>();
 	config.wiredtiger.create_table_config = wiredtiger["create_table_config"].as<string>();
 	config.wiredtiger.print_stats = wiredtiger["print_stats"].as<bool>();
+	YAML::Node stat_counter_list = wiredtiger["stat_counter_list"];
+	for (YAML::iterator iter = stat_counter_list.begin(); iter != stat_counter_list.end(); ++iter)
+		config.wiredtiger.stat_counter_list.push_back((*iter).as<string>());
+	YAML::Node stat_gauge_list = wiredtiger["stat_gauge_list"];
+	for (YAML::iterator iter = stat_gauge_list.begin(); iter != stat_gauge_list.end(); ++iter)
+		config.wiredtiger.stat_gauge_list.push_back((*iter).as<string>());
+
+	config.measurement = MeasurementConfig::parse_yaml(root);
+	config.sweep = SweepConfig::parse_yaml(root);
+	/* sample i/o of the device the database lives on unless told otherwise */
+	if (config.measurement.data_dir.empty())
+		config.measurement.data_dir = config.wiredtiger.data_dir;
 
 	return config;
 }